@@ -126,6 +126,135 @@
 # define CONFIG_CORE_TIMER_EVENT_FREQ   100ul
 #endif
 
+/**@brief       Number of bits of tick resolved by each timing wheel level
+ * @details     Each level of timer wheel has 2^CONFIG_TIMER_WHEEL_BITS slots
+ *              and there are as many levels as needed to cover 32-bit tick
+ *              range. Higher values use more memory and cascade less often.
+ *              Possible values:
+ *              - Min: 1
+ *              - Max: 8
+ * @note        Default settings: 6 (64 slots per level, 6 levels)
+ */
+#if !defined(CONFIG_TIMER_WHEEL_BITS)
+# define CONFIG_TIMER_WHEEL_BITS        6u
+#endif
+
+/**@brief       Enable/disable batched timer callbacks
+ * @details     Possible values:
+ *              - 0 - timer callbacks are called from ncore_timer_isr()
+ *              - 1 - ncore_timer_isr() only collects the expired timers and
+ *                    the port runs their callbacks with
+ *                    @ref ntimer_run_expired after releasing the lock. The
+ *                    port must support this mode.
+ * @note        Default settings: 0 (callbacks are called from core timer)
+ */
+#if !defined(CONFIG_TIMER_BATCH)
+# define CONFIG_TIMER_BATCH             0
+#endif
+
+/**@brief       Enable/disable high resolution timers
+ * @details     Possible values:
+ *              - 0 - high resolution timers are disabled
+ *              - 1 - timers with 64-bit nanosecond deadlines on
+ *                    CLOCK_MONOTONIC are available, see @ref nhrtimer_start.
+ *                    Requires POSIX threads.
+ * @note        Default settings: 0 (high resolution timers are disabled)
+ */
+#if !defined(CONFIG_HRTIMER)
+# define CONFIG_HRTIMER                 0
+#endif
+
+/**@brief       Maximum number of running high resolution timers
+ */
+#if !defined(CONFIG_HRTIMER_MAX)
+# define CONFIG_HRTIMER_MAX             64u
+#endif
+
+/**@} *//*----------------------------------------------------------------*//**
+ * @name        eds::mm Memory management configuration
+ * @{ *//*--------------------------------------------------------------------*/
+
+/**@brief       Maximum size of TLSF memory storage as a power of 2
+ * @details     The control structure of TLSF allocator has a free block bin
+ *              array for each power of 2 up to this size, so smaller values
+ *              save memory on small targets. Possible values:
+ *              - Min: 12 (4kB)
+ *              - Max: 31 (2GB) when size_t is 32 bits wide
+ *              - Max: 63 when size_t is 64 bits wide
+ */
+#if !defined(CONFIG_TLSF_MAX_SIZE_BITS)
+# define CONFIG_TLSF_MAX_SIZE_BITS      24u
+#endif
+
+/**@brief       Number of free blocks which a thread caches for each lock-free
+ *              pool
+ * @details     The cache is used only when the port supports thread local
+ *              variables. Possible values:
+ *              - 0 - cache is disabled, every operation uses the shared stack
+ *              - Max: 1024
+ */
+#if !defined(CONFIG_LFPOOL_CACHE)
+# define CONFIG_LFPOOL_CACHE            16u
+#endif
+
+/**@brief       Size of a slab in bytes
+ * @details     Slabs are allocated from the backing memory object of slab
+ *              allocator. Possible values:
+ *              - Min: 256
+ */
+#if !defined(CONFIG_SLAB_SIZE)
+# define CONFIG_SLAB_SIZE               4096u
+#endif
+
+/**@brief       Alignment of slab objects in bytes, usually the size of CPU
+ *              cache line
+ * @details     Possible values: a power of 2
+ */
+#if !defined(CONFIG_SLAB_ALIGN)
+# define CONFIG_SLAB_ALIGN              64u
+#endif
+
+/**@brief       Enable/disable memory allocator statistics
+ * @details     Possible values:
+ *              - 0 - statistics are disabled
+ *              - 1 - allocations and frees done through memory object API
+ *                    are counted, see @ref nmem_get_stats.
+ * @note        Default settings: 0 (statistics are disabled)
+ */
+#if !defined(CONFIG_MEM_STATS)
+# define CONFIG_MEM_STATS               0
+#endif
+
+/**@brief       Number of allocation call sites which are tracked
+ * @details     Allocations from sites which do not fit are counted only in
+ *              statistics of memory object. Possible values:
+ *              - 0 - call sites are not tracked
+ *              - Max: 1024
+ */
+#if !defined(CONFIG_MEM_STATS_SITES)
+# define CONFIG_MEM_STATS_SITES         32u
+#endif
+
+/**@brief       Enable/disable huge page memory regions
+ * @details     Possible values:
+ *              - 0 - huge page memory is disabled
+ *              - 1 - large memory regions can be mapped with huge pages and
+ *                    bound to a NUMA node, see @ref nhugemem_init. Requires
+ *                    Linux.
+ * @note        Default settings: 0 (huge page memory is disabled)
+ */
+#if !defined(CONFIG_HUGEMEM)
+# define CONFIG_HUGEMEM                 0
+#endif
+
+/**@brief       Size of huge page in bytes
+ * @details     Region sizes are rounded up to this size. Possible values: a
+ *              power of 2
+ */
+#if !defined(CONFIG_HUGEMEM_PAGE_SIZE)
+# define CONFIG_HUGEMEM_PAGE_SIZE       (2ul * 1024ul * 1024ul)
+#endif
+
 /**@} *//*----------------------------------------------------------------*//**
  * @name        eds::sched Scheduler configuration
  * @{ *//*--------------------------------------------------------------------*/
@@ -156,6 +285,16 @@
 # define CONFIG_REGISTRY_NAME_SIZE      16u
 #endif
 
+/**@brief       Number of deferred job priority levels
+ * @details     Jobs of higher priority level are executed before jobs of
+ *              lower priority level. Possible values:
+ *              - Min: 1 (all jobs are executed in submission order)
+ *              - Max: 8
+ */
+#if !defined(CONFIG_DEFERRED_PRIORITIES)
+# define CONFIG_DEFERRED_PRIORITIES     1u
+#endif
+
 
 /**@} *//*----------------------------------------------------------------*//**
  * @name        eds::ep Event Processing configuration
@@ -203,12 +342,152 @@
 # define CONFIG_EVENT_STORAGE_NPOOLS    2
 #endif
 
+/**@brief       Use compact event header
+ * @details     Possible values:
+ *              - 0 - event header holds memory pointer and native width
+ *                    counters
+ *              - 1 - event header holds 16-bit id and reference counter, 8-bit
+ *                    attributes and 8-bit storage index. Producer and size
+ *                    fields (if enabled) are placed after the compact part.
+ *
+ *              Compact header is 6 bytes long without optional fields. Events
+ *              allocated from memory which was not registered with
+ *              @ref nevent_register_mem can not be used in this mode.
+ * @note        Default settings: 0 (regular event header)
+ */
+#if !defined(CONFIG_EVENT_COMPACT)
+# define CONFIG_EVENT_COMPACT           0
+#endif
+
+/**@brief       Enable/disable reserved event capacity
+ * @details     Possible values:
+ *              - 0 - any producer may allocate events while there is free
+ *                    event storage
+ *              - 1 - event storage may hold a reserve which only producers
+ *                    of high priority may use, see @ref nevent_set_reserve
+ * @note        Default settings: 0 (reserved capacity is disabled)
+ */
+#if !defined(CONFIG_EVENT_RESERVE)
+# define CONFIG_EVENT_RESERVE           0
+#endif
+
+/**@brief       Enable/disable shared memory event bus
+ * @details     Possible values:
+ *              - 0 - event bus is disabled
+ *              - 1 - event bus is enabled, events can be sent to EPAs in other
+ *                    processes on the same host. Requires POSIX shared memory
+ *                    and @ref CONFIG_EVENT_SIZE.
+ * @note        Default settings: 0 (event bus is disabled)
+ */
+#if !defined(CONFIG_EBUS)
+# define CONFIG_EBUS                    0
+#endif
+
+/**@brief       Number of local EPA identifiers which can be bound to a bus
+ */
+#if !defined(CONFIG_EBUS_EPA_IDS)
+# define CONFIG_EBUS_EPA_IDS            32u
+#endif
+
+/**@brief       Enable/disable event trace recording and replay
+ * @details     Possible values:
+ *              - 0 - event trace is disabled
+ *              - 1 - events delivered to EPAs can be recorded to a file and
+ *                    replayed later. Requires standard C library file I/O
+ *                    and @ref CONFIG_EVENT_SIZE.
+ * @note        Default settings: 0 (event trace is disabled)
+ */
+#if !defined(CONFIG_ETRACE)
+# define CONFIG_ETRACE                  0
+#endif
+
+/**@brief       Maximum number of distinct EPAs in one event trace
+ */
+#if !defined(CONFIG_ETRACE_EPAS)
+# define CONFIG_ETRACE_EPAS             64u
+#endif
+
+/**@brief       Number of event slots for delayed event delivery
+ * @details     Possible values:
+ *              - 0 - delayed event delivery is disabled
+ *              - 1 - 65535 - maximum number of events which may be pending for
+ *                    delivery by @ref nepa_send_event_after and
+ *                    @ref nepa_send_event_at at the same time.
+ * @note        Default settings: 0 (delayed event delivery is disabled)
+ */
+#if !defined(CONFIG_ETIMER_DELAYED_SLOTS)
+# define CONFIG_ETIMER_DELAYED_SLOTS    0u
+#endif
+
+/**@brief       Enable/disable aggregated event timer delivery
+ * @details     Possible values:
+ *              - 0 - each expired event timer puts its event into EPA queue
+ *              - 1 - expired event timers are linked to a per-EPA expiry
+ *                    list. All timers in the list are dispatched at once,
+ *                    using a single scheduler insert and no queue slots.
+ * @note        Default settings: 0 (each timer uses a queue slot)
+ */
+#if !defined(CONFIG_ETIMER_AGGREGATE)
+# define CONFIG_ETIMER_AGGREGATE        0
+#endif
+
+/**@brief       Size of per-dispatch scratch arena in bytes
+ * @details     Memory allocated from the arena returned by @ref nepa_scratch
+ *              is released when the state machine handler returns.
+ *              Possible values:
+ *              - 0 - scratch arena is disabled
+ *              - Min: 64
+ * @note        Default settings: 0 (scratch arena is disabled)
+ */
+#if !defined(CONFIG_EPA_SCRATCH_SIZE)
+# define CONFIG_EPA_SCRATCH_SIZE        0u
+#endif
+
 #if !defined(CONFIG_SMP_HSM)
 # define CONFIG_SMP_HSM                 1
 #endif
 
-#if !defined(CONFIG_SMP_HSM_PATH_DEPTH)
-#define CONFIG_SMP_HSM_PATH_DEPTH       8
+/**@brief       Number of states whose super state and depth are cached
+ * @details     HSM dispatcher learns the hierarchy of each state the first
+ *              time it takes part in a transition. When the cache is full the
+ *              hierarchy of remaining states is discovered on each transition.
+ *              Must be a power of 2.
+ */
+#if !defined(CONFIG_SMP_HSM_STATE_CACHE)
+# define CONFIG_SMP_HSM_STATE_CACHE     64u
+#endif
+
+/**@brief       Number of cached HSM transition paths
+ * @details     Each entry remembers the least common ancestor of a source and
+ *              target state pair. Must be a power of 2.
+ */
+#if !defined(CONFIG_SMP_HSM_PATH_CACHE)
+# define CONFIG_SMP_HSM_PATH_CACHE      32u
+#endif
+
+/**@brief       Number of memoized HSM event handlers
+ * @details     Possible values:
+ *              - 0 - HSM dispatcher calls every state up the hierarchy until
+ *                    a state handles the event
+ *              - power of 2 - states may declare which events they handle
+ *                    with @ref nsm_state_handles. HSM dispatcher remembers
+ *                    which state handles each (state, event id) pair and
+ *                    skips the states which do not handle it.
+ * @note        Default settings: 0 (event handlers are not memoized)
+ */
+#if !defined(CONFIG_SMP_HSM_HANDLER_CACHE)
+# define CONFIG_SMP_HSM_HANDLER_CACHE   0u
+#endif
+
+/**@brief       Enable/disable table driven state machines
+ * @details     Possible values:
+ *              - 0 - table driven state machines are disabled
+ *              - 1 - state machines generated by scripts/gen_sm_table.py can
+ *                    be dispatched, see @ref nsm_table_init.
+ * @note        Default settings: 0 (table driven state machines are disabled)
+ */
+#if !defined(CONFIG_SMP_TABLE)
+# define CONFIG_SMP_TABLE               0
 #endif
 
 /**@} *//*--------------------------------------------------------------------*/
@@ -230,6 +509,110 @@
 # error "NEON::eds::base: Configuration option CONFIG_DEBUG_INTERNAL_CHECK is out of range: 0 = disabled, 1 = enabled"
 #endif
 
+#if ((CONFIG_EVENT_COMPACT != 1) && (CONFIG_EVENT_COMPACT != 0))
+# error "NEON::eds::ep: Configuration option CONFIG_EVENT_COMPACT is out of range: 0 = disabled, 1 = enabled"
+#endif
+
+#if ((CONFIG_EVENT_RESERVE != 1) && (CONFIG_EVENT_RESERVE != 0))
+# error "NEON::eds::ep: Configuration option CONFIG_EVENT_RESERVE is out of range: 0 = disabled, 1 = enabled"
+#endif
+
+#if (CONFIG_EVENT_COMPACT == 1) && (CONFIG_EVENT_STORAGE_NPOOLS > 254)
+# error "NEON::eds::ep: Configuration option CONFIG_EVENT_STORAGE_NPOOLS must be less than 255 when CONFIG_EVENT_COMPACT is enabled"
+#endif
+
+#if (CONFIG_EBUS == 1) && (CONFIG_EVENT_SIZE != 1)
+# error "NEON::eds::ep: Configuration option CONFIG_EBUS requires CONFIG_EVENT_SIZE to be enabled"
+#endif
+
+#if (CONFIG_ETRACE == 1) && (CONFIG_REGISTRY != 1)
+# error "NEON::eds::ep: Configuration option CONFIG_ETRACE requires CONFIG_REGISTRY to be enabled"
+#endif
+
+#if (CONFIG_ETRACE == 1) && (CONFIG_EVENT_SIZE != 1)
+# error "NEON::eds::ep: Configuration option CONFIG_ETRACE requires CONFIG_EVENT_SIZE to be enabled"
+#endif
+
+#if (CONFIG_TLSF_MAX_SIZE_BITS < 12u) || (CONFIG_TLSF_MAX_SIZE_BITS > 63u)
+# error "NEON::eds::mm: Configuration option CONFIG_TLSF_MAX_SIZE_BITS is out of range: 12 - 63"
+#endif
+
+#if (CONFIG_LFPOOL_CACHE > 1024u)
+# error "NEON::eds::mm: Configuration option CONFIG_LFPOOL_CACHE is out of range: 0 - 1024"
+#endif
+
+#if (CONFIG_SLAB_SIZE < 256u)
+# error "NEON::eds::mm: Configuration option CONFIG_SLAB_SIZE must be at least 256"
+#endif
+
+#if ((CONFIG_SLAB_ALIGN & (CONFIG_SLAB_ALIGN - 1u)) != 0u) || (CONFIG_SLAB_ALIGN == 0u)
+# error "NEON::eds::mm: Configuration option CONFIG_SLAB_ALIGN must be a power of 2"
+#endif
+
+#if ((CONFIG_MEM_STATS != 1) && (CONFIG_MEM_STATS != 0))
+# error "NEON::eds::mm: Configuration option CONFIG_MEM_STATS is out of range: 0 = disabled, 1 = enabled"
+#endif
+
+#if (CONFIG_MEM_STATS_SITES > 1024u)
+# error "NEON::eds::mm: Configuration option CONFIG_MEM_STATS_SITES is out of range: 0 - 1024"
+#endif
+
+#if ((CONFIG_HUGEMEM != 1) && (CONFIG_HUGEMEM != 0))
+# error "NEON::eds::mm: Configuration option CONFIG_HUGEMEM is out of range: 0 = disabled, 1 = enabled"
+#endif
+
+#if ((CONFIG_HUGEMEM_PAGE_SIZE & (CONFIG_HUGEMEM_PAGE_SIZE - 1u)) != 0u) || (CONFIG_HUGEMEM_PAGE_SIZE == 0u)
+# error "NEON::eds::mm: Configuration option CONFIG_HUGEMEM_PAGE_SIZE must be a power of 2"
+#endif
+
+#if (CONFIG_DEFERRED_PRIORITIES < 1u) || (CONFIG_DEFERRED_PRIORITIES > 8u)
+# error "NEON::eds::sched: Configuration option CONFIG_DEFERRED_PRIORITIES is out of range: 1 - 8"
+#endif
+
+#if (CONFIG_TIMER_WHEEL_BITS < 1u) || (CONFIG_TIMER_WHEEL_BITS > 8u)
+# error "NEON::eds::timer: Configuration option CONFIG_TIMER_WHEEL_BITS is out of range: 1 - 8"
+#endif
+
+#if ((CONFIG_TIMER_BATCH != 1) && (CONFIG_TIMER_BATCH != 0))
+# error "NEON::eds::timer: Configuration option CONFIG_TIMER_BATCH is out of range: 0 = disabled, 1 = enabled"
+#endif
+
+#if ((CONFIG_HRTIMER != 1) && (CONFIG_HRTIMER != 0))
+# error "NEON::eds::timer: Configuration option CONFIG_HRTIMER is out of range: 0 = disabled, 1 = enabled"
+#endif
+
+#if (CONFIG_HRTIMER == 1) && (CONFIG_HRTIMER_MAX < 1u)
+# error "NEON::eds::timer: Configuration option CONFIG_HRTIMER_MAX must be greater than 0"
+#endif
+
+#if ((CONFIG_ETIMER_AGGREGATE != 1) && (CONFIG_ETIMER_AGGREGATE != 0))
+# error "NEON::eds::ep: Configuration option CONFIG_ETIMER_AGGREGATE is out of range: 0 = disabled, 1 = enabled"
+#endif
+
+#if (CONFIG_EPA_SCRATCH_SIZE != 0u) && (CONFIG_EPA_SCRATCH_SIZE < 64u)
+# error "NEON::eds::ep: Configuration option CONFIG_EPA_SCRATCH_SIZE must be 0 or at least 64"
+#endif
+
+#if (CONFIG_ETIMER_DELAYED_SLOTS > 65535u)
+# error "NEON::eds::ep: Configuration option CONFIG_ETIMER_DELAYED_SLOTS is out of range: 0 - 65535"
+#endif
+
+#if ((CONFIG_SMP_HSM_HANDLER_CACHE & (CONFIG_SMP_HSM_HANDLER_CACHE - 1u)) != 0u)
+# error "NEON::eds::ep: Configuration option CONFIG_SMP_HSM_HANDLER_CACHE must be 0 or a power of 2"
+#endif
+
+#if ((CONFIG_SMP_TABLE != 1) && (CONFIG_SMP_TABLE != 0))
+# error "NEON::eds::ep: Configuration option CONFIG_SMP_TABLE is out of range: 0 = disabled, 1 = enabled"
+#endif
+
+#if ((CONFIG_SMP_HSM_STATE_CACHE & (CONFIG_SMP_HSM_STATE_CACHE - 1u)) != 0u) || (CONFIG_SMP_HSM_STATE_CACHE == 0u)
+# error "NEON::eds::ep: Configuration option CONFIG_SMP_HSM_STATE_CACHE must be a power of 2"
+#endif
+
+#if ((CONFIG_SMP_HSM_PATH_CACHE & (CONFIG_SMP_HSM_PATH_CACHE - 1u)) != 0u) || (CONFIG_SMP_HSM_PATH_CACHE == 0u)
+# error "NEON::eds::ep: Configuration option CONFIG_SMP_HSM_PATH_CACHE must be a power of 2"
+#endif
+
 #if !defined(CONFIG_CORE_TIMER_CLOCK_FREQ)
 # error "NEON::eds::port: Configuration option CONFIG_CORE_TIMER_CLOCK_FREQ is not set!"
 #endif
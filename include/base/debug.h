@@ -145,7 +145,13 @@
 #define NSIGNATURE_POOL                     ((unsigned int)0xdeadbee1u)
 #define NSIGNATURE_STATIC                   ((unsigned int)0xdeadbee2u)
 #define NSIGNATURE_STDHEAP                  ((unsigned int)0xdeadbee3u)
+#define NSIGNATURE_TLSF                     ((unsigned int)0xdeadbee4u)
+#define NSIGNATURE_LFPOOL                   ((unsigned int)0xdeadbee5u)
+#define NSIGNATURE_SLAB                     ((unsigned int)0xdeadbee6u)
+#define NSIGNATURE_ARENA                    ((unsigned int)0xdeadbee7u)
+#define NSIGNATURE_EPOOL                    ((unsigned int)0xdeadbee8u)
 #define NSIGNATURE_TIMER                    ((unsigned int)0xdeadcee0u)
+#define NSIGNATURE_HRTIMER                  ((unsigned int)0xdeadcee1u)
 #define NSIGNATURE_THREAD                   ((unsigned int)0xdeaddee0u)
 #define NSIGNATURE_EPA                      ((unsigned int)0xdeadfeeau)
 #define NSIGNATURE_EQUEUE                   ((unsigned int)0xdeadfeebu)
@@ -153,6 +159,8 @@
 #define NSIGNATURE_EVENT                    ((unsigned int)0xdeadfeedu)
 #define NSIGNATURE_SM                       ((unsigned int)0xdeadfeeeu)
 #define NSIGNATURE_DEFER                    ((unsigned int)0xdeadfeefu)
+#define NSIGNATURE_EBUS                     ((unsigned int)0xdeadfef0u)
+#define NSIGNATURE_SM_ARRAY                 ((unsigned int)0xdeadfef1u)
 
 #if (CONFIG_API_VALIDATION == 1)
 #define NSIGNATURE_DECLARE                 	int _signature;
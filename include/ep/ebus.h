@@ -0,0 +1,238 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Shared memory event bus
+ * @defgroup    event_bus Shared memory event bus
+ * @brief       Shared memory event bus
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     event_bus
+@section        ebus_usage Using the event bus
+
+Every process which receives events opens a bus under an unique name and binds
+its local EPAs to bus identifiers:
+
+@code
+static struct nebus bus;
+
+nebus_open(&bus, "/app-worker", 1024, 256);
+nebus_bind(&bus, 1, NEPA_FROM_BUNDLE(&worker_epa));
+@endcode
+
+A process which sends events opens a proxy to remote EPA and then uses the
+proxy EPA as any other EPA:
+
+@code
+static struct nebus_proxy worker;
+
+nebus_proxy_open(&worker, "/app-worker", 1);
+nepa_send_event(nebus_proxy_epa(&worker), event);
+@endcode
+
+Events are copied into a ring which lives in shared memory. Only the event id
+and data following the event header are transferred, so the encoding does not
+depend on addresses in either process. The sender does not issue any system
+call unless the receiving thread is sleeping on an empty ring.
+*/
+
+#ifndef NEON_EP_EBUS_H_
+#define NEON_EP_EBUS_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "base/config.h"
+#include "base/debug.h"
+#include "base/error.h"
+#include "ep/epa.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Validate the pointer to event bus object
+ * @note        This macro may be used only when @ref CONFIG_API_VALIDATION
+ *              macro is enabled.
+ * @api
+ */
+#if (CONFIG_API_VALIDATION == 1) || defined(__DOXYGEN__)
+#define N_IS_EBUS_OBJECT(ebus_obj)                                              \
+    (NSIGNATURE_OF(ebus_obj) == NSIGNATURE_EBUS)
+#else
+#define N_IS_EBUS_OBJECT(ebus_obj)      (ebus_obj)
+#endif
+
+/**@brief       Get the EPA object of a proxy
+ * @details     The returned pointer can be passed to any EPA event transport
+ *              function.
+ * @api
+ */
+#define nebus_proxy_epa(proxy)          (&(proxy)->epa)
+
+/*-------------------------------------------------------  C++ extern base  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+struct nevent;
+struct nebus_ring;
+
+/**@brief       Event bus receiving end
+ * @details     All elements of this structure are private members.
+ * @api
+ */
+struct nebus
+{
+    NSIGNATURE_DECLARE
+    struct nebus_ring *         ring;   /**<@brief Mapped ring            */
+    size_t                      map_size;
+    const char *                name;   /**<@brief Shared memory name     */
+    pthread_t                   thread; /**<@brief Receiving thread       */
+    volatile bool               should_exit;
+                                        /**<@brief Bound local EPAs       */
+    struct nepa *               epa[CONFIG_EBUS_EPA_IDS];
+};
+
+/**@brief       Event bus receiving end type
+ * @api
+ */
+typedef struct nebus nebus;
+
+/**@brief       Local proxy of an EPA in another process
+ * @details     All elements of this structure are private members.
+ * @api
+ */
+struct nebus_proxy
+{
+    NSIGNATURE_DECLARE
+    struct nepa                 epa;    /**<@brief Proxy EPA object       */
+    struct nebus_ring *         ring;   /**<@brief Mapped ring            */
+    size_t                      map_size;
+    uint16_t                    epa_id; /**<@brief Remote EPA identifier  */
+};
+
+/**@brief       Local proxy type
+ * @api
+ */
+typedef struct nebus_proxy nebus_proxy;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+/*------------------------------------------------------------------------*//**
+ * @name        Receiving end
+ * @{ *//*--------------------------------------------------------------------*/
+
+/**@brief       Create a bus and start the receiving thread
+ * @param       bus
+ *              Pointer to bus structure
+ * @param       name
+ *              Shared memory object name, for example "/my-bus". The string
+ *              must remain valid until the bus is closed.
+ * @param       slots
+ *              Number of slots in the ring. Must be a power of 2.
+ * @param       slot_size
+ *              Maximum event size in bytes which can be transferred.
+ * @return      Operation status
+ *  @retval     NERROR_NONE - bus is ready
+ *  @retval     NERROR_NO_RESOURCE - shared memory could not be created
+ *  @retval     NERROR_NOT_PERMITTED - shared memory object with this name
+ *              already exists. A bus left behind by a receiver which did not
+ *              close it must be removed with shm_unlink() first.
+ *  @retval     NERROR_ARG_INVALID - invalid number of slots
+ * @api
+ */
+nerror nebus_open(struct nebus * bus, const char * name, uint32_t slots,
+        size_t slot_size);
+
+
+
+/**@brief       Stop receiving thread and remove the bus
+ * @api
+ */
+void nebus_close(struct nebus * bus);
+
+
+
+/**@brief       Bind a local EPA to bus identifier
+ * @param       bus
+ *              Pointer to bus structure
+ * @param       epa_id
+ *              Bus identifier, must be less than @ref CONFIG_EBUS_EPA_IDS
+ * @param       epa
+ *              Local EPA which will receive events sent to the identifier. If
+ *              NULL the identifier is unbound.
+ * @api
+ */
+void nebus_bind(struct nebus * bus, uint16_t epa_id, struct nepa * epa);
+
+/**@} *//*----------------------------------------------------------------*//**
+ * @name        Sending end
+ * @{ *//*--------------------------------------------------------------------*/
+
+/**@brief       Open a proxy to an EPA in another process
+ * @param       proxy
+ *              Pointer to proxy structure
+ * @param       name
+ *              Shared memory object name used by receiving end
+ * @param       epa_id
+ *              Bus identifier of remote EPA
+ * @return      Operation status
+ *  @retval     NERROR_NONE - proxy is ready
+ *  @retval     NERROR_OBJECT_NFOUND - there is no bus with the given name
+ * @api
+ */
+nerror nebus_proxy_open(struct nebus_proxy * proxy, const char * name,
+        uint16_t epa_id);
+
+
+
+/**@brief       Close the proxy
+ * @api
+ */
+void nebus_proxy_close(struct nebus_proxy * proxy);
+
+
+
+/**@brief       Copy an event to remote EPA
+ * @details     This function is called by EPA event transport functions when
+ *              the destination EPA is a proxy.
+ * @notapi
+ */
+nerror nebus_send_i(struct nebus_proxy * proxy, const struct nevent * event);
+
+/**@} *//*------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of ebus.h
+ ******************************************************************************/
+#endif /* NEON_EP_EBUS_H_ */
@@ -34,6 +34,7 @@
 /*=========================================================  INCLUDE FILES  ==*/
 
 #include "port/compiler.h"
+#include "base/dlist.h"
 #include "base/error.h"
 #include "base/queue.h"
 #include "base/config.h"
@@ -63,6 +64,16 @@
 #define N_EPA_MEM
 #endif
 
+/**
+ * @brief       Helper macro for EPA expired timer list
+ * @notapi
+ */
+#if (CONFIG_ETIMER_AGGREGATE == 1) || defined(__DOXYGEN__)
+#define N_EPA_EXPIRED(epa)              .expired = NDLIST_INITIALIZER((epa).expired),
+#else
+#define N_EPA_EXPIRED(epa)
+#endif
+
 /**
  * @brief       Get the pointer to EPA from thread structure
  * @notapi
@@ -82,6 +93,7 @@
 	{                                                                           \
 		.b = {                                                                  \
             N_EPA_MEM                                                           \
+            N_EPA_EXPIRED(name.b)                                               \
             NSIGNATURE_INITIALIZER(NSIGNATURE_EPA)                              \
             .thread = NTHREAD_INITIALIZER(name.b.thread, NULL, priority),       \
             .sm = (&name.sm.b),                                                 \
@@ -109,6 +121,7 @@ extern "C" {
  */
 struct nmem;
 struct nevent;
+struct nebus_proxy;
 
 /**
  * @brief       EPA object
@@ -124,6 +137,13 @@ struct nepa
 	struct nsm *                sm;     /**<@brief State machine processor    */
 	struct nqueue *             queue;
 										/**<@brief Working event queue        */
+#if (CONFIG_EBUS == 1) || defined(__DOXYGEN__)
+                                        /**<@brief Event bus proxy, if remote */
+    struct nebus_proxy *        proxy;
+#endif
+#if (CONFIG_ETIMER_AGGREGATE == 1) || defined(__DOXYGEN__)
+    struct ndlist               expired;/**<@brief Expired event timers   */
+#endif
 };
 
 /**
@@ -199,6 +219,23 @@ void * nepa_create_storage(size_t size);
  */
 void nepa_delete_storage(void * storage);
 
+
+
+/**
+ * @brief       Get the scratch arena of current dispatch
+ * @details     Memory allocated from the arena with @ref narena_alloc or
+ *              @ref nmem_alloc does not take the core lock and does not need
+ *              to be freed. Everything allocated from the arena is released
+ *              when the state machine handler returns, so the memory must not
+ *              be referenced by events or by EPA data.
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_EPA_SCRATCH_SIZE must be greater than zero.
+ * @api
+ */
+#if (CONFIG_EPA_SCRATCH_SIZE != 0u) || defined(__DOXYGEN__)
+struct nmem * nepa_scratch(void);
+#endif
+
 /**@} *//*----------------------------------------------------------------*//**
  * @name        Deferred event management
  * @details     When a SM returns naction_deffered() action the currently 
@@ -35,7 +35,9 @@
 #include <stdint.h>
 
 #include "base/config.h"
+#include "base/error.h"
 #include "timer/timer.h"
+#include "timer/hrtimer.h"
 #include "ep/event.h"
 
 /*===============================================================  MACRO's  ==*/
@@ -52,6 +54,11 @@
 #define N_IS_ETIMER_OBJECT(etimer_obj)  (etimer_obj)
 #endif
 
+/**@brief       Invalid delayed event handle
+ * @api
+ */
+#define NDELAYED_INVALID                0u
+
 /*-------------------------------------------------------  C++ extern base  --*/
 #ifdef __cplusplus
 extern "C" {
@@ -66,9 +73,22 @@ struct netimer
 	NSIGNATURE_DECLARE
 	struct nepa *               epa;
     struct ntimer               timer;
+#if (CONFIG_HRTIMER == 1) || defined(__DOXYGEN__)
+    struct nhrtimer             hrtimer;
+#endif
+#if (CONFIG_ETIMER_AGGREGATE == 1) || defined(__DOXYGEN__)
+    struct ndlist               expired;/**<@brief EPA expiry list entry  */
+#endif
     struct nevent               event;
 };
 
+/**@brief       Handle of a pending delayed event
+ * @details     The handle stays unique after the event is delivered or
+ *              cancelled, so a stale handle can be safely cancelled.
+ * @api
+ */
+typedef uint32_t ndelayed;
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*===================================================  FUNCTION PROTOTYPES  ==*/
 
@@ -81,11 +101,25 @@ void netimer_term(struct netimer * timer);
 
 
 
-void netimer_after(struct netimer * timer, uint32_t tick, uint16_t event_id);
+/**@brief       Send an event to timer owner after the given number of ticks
+ * @param       slack
+ *              Number of ticks the event may be delayed by, see
+ *              @ref ntimer_start.
+ * @api
+ */
+void netimer_after(struct netimer * timer, uint32_t tick, uint32_t slack,
+        uint16_t event_id);
 
 
 
-void netimer_every(struct netimer * timer, uint32_t tick, uint16_t event_id);
+/**@brief       Send an event to timer owner every @c tick ticks
+ * @param       slack
+ *              Number of ticks each event may be delayed by, see
+ *              @ref ntimer_start.
+ * @api
+ */
+void netimer_every(struct netimer * timer, uint32_t tick, uint32_t slack,
+        uint16_t event_id);
 
 
 
@@ -99,6 +133,89 @@ bool netimer_is_running_i(const struct netimer * timer);
 
 uint32_t netimer_remaining(const struct netimer * timer);
 
+
+
+#if (CONFIG_HRTIMER == 1) || defined(__DOXYGEN__)
+/**@brief       Send an event to timer owner after the given number of
+ *              nanoseconds
+ * @return      Operation status, see @ref nhrtimer_start_i.
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_HRTIMER must be enabled.
+ * @api
+ */
+nerror netimer_after_ns(struct netimer * timer, uint64_t ns, uint64_t slack,
+        uint16_t event_id);
+
+
+
+/**@brief       Send an event to timer owner every @c ns nanoseconds
+ * @details     Deadlines do not drift, each one is exactly @c ns after the
+ *              previous one.
+ * @return      Operation status, see @ref nhrtimer_start_i.
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_HRTIMER must be enabled.
+ * @api
+ */
+nerror netimer_every_ns(struct netimer * timer, uint64_t ns, uint64_t slack,
+        uint16_t event_id);
+#endif
+
+
+
+#if (CONFIG_ETIMER_DELAYED_SLOTS != 0u) || defined(__DOXYGEN__)
+/**@brief       Send an event to EPA after the given number of ticks
+ * @param       epa
+ *              Pointer to destination EPA
+ * @param       event
+ *              Pointer to event, the event is held until delivered or
+ *              cancelled.
+ * @param       tick
+ *              Number of ticks to wait
+ * @param       handle
+ *              Pointer to handle which can be used to cancel the delivery. May
+ *              be NULL when the delivery will not be cancelled.
+ * @return      Operation status
+ *  @retval     NERROR_NONE - the event is scheduled for delivery
+ *  @retval     NERROR_NO_RESOURCE - there is no free delayed event slot, see
+ *              @ref CONFIG_ETIMER_DELAYED_SLOTS
+ * @api
+ */
+nerror nepa_send_event_after(struct nepa * epa, const struct nevent * event,
+        uint32_t tick, ndelayed * handle);
+
+
+
+/**@brief       Send an event to EPA at the given core timer tick
+ * @param       epa
+ *              Pointer to destination EPA
+ * @param       event
+ *              Pointer to event
+ * @param       tick
+ *              Absolute tick as returned by @ref ntimer_get_tick. If the tick
+ *              is already in the past the event is sent immediately.
+ * @param       handle
+ *              Pointer to handle, may be NULL.
+ * @return      Operation status, see @ref nepa_send_event_after.
+ * @api
+ */
+nerror nepa_send_event_at(struct nepa * epa, const struct nevent * event,
+        uint32_t tick, ndelayed * handle);
+
+
+
+/**@brief       Cancel a delayed event delivery
+ * @param       handle
+ *              Handle returned by @ref nepa_send_event_after or
+ *              @ref nepa_send_event_at.
+ * @return      Operation status
+ *  @retval     NERROR_NONE - the delivery is cancelled and event is released
+ *  @retval     NERROR_OBJECT_NFOUND - the event was already delivered or the
+ *              delivery was already cancelled
+ * @api
+ */
+nerror nepa_cancel_event(ndelayed handle);
+#endif
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
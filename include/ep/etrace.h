@@ -0,0 +1,187 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Event trace recording and replay
+ * @defgroup    event_trace Event trace
+ * @brief       Event trace recording and replay
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     event_trace
+@section        etrace_format Trace file format
+
+The file starts with the 4 byte magic "NTRC" followed by a version byte. Then
+follows a sequence of records. Each record starts with a tag byte and all
+numbers are unsigned LEB128 variable length integers:
+
+- EPA record (tag 1): EPA index, name length, name bytes. It is written the
+  first time an EPA receives an event. Names longer than 255 bytes are
+  truncated.
+- Event record (tag 2): EPA index, nanoseconds elapsed since previous event
+  record, event id, data size, data bytes following the event header.
+
+EPAs are matched by their registry name during replay, so the same trace can
+be replayed into a new process instance.
+*/
+
+#ifndef NEON_EP_ETRACE_H_
+#define NEON_EP_ETRACE_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "base/config.h"
+#include "base/error.h"
+
+/*===============================================================  MACRO's  ==*/
+/*-------------------------------------------------------  C++ extern base  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+struct nepa;
+struct nevent;
+
+/**@brief       Replay pacing
+ * @api
+ */
+enum netrace_pace
+{
+    NETRACE_PACE_FAST       = 0u,       /**<@brief As fast as possible        */
+    NETRACE_PACE_RECORDED   = 1u        /**<@brief Keep recorded timing       */
+};
+
+/**@brief       Trace replay structure
+ * @details     All elements of this structure are private members.
+ * @api
+ */
+struct netrace_replay
+{
+    FILE *                      file;
+    struct nepa * const *       epas;   /**<@brief Candidate EPAs         */
+    size_t                      n_epas;
+                                        /**<@brief Trace index to EPA map */
+    struct nepa *               map[CONFIG_ETRACE_EPAS];
+    uint32_t                    dropped;/**<@brief Unresolved events      */
+};
+
+/**@brief       Trace replay type
+ * @api
+ */
+typedef struct netrace_replay netrace_replay;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+/*------------------------------------------------------------------------*//**
+ * @name        Recording
+ * @{ *//*--------------------------------------------------------------------*/
+
+/**@brief       Start recording all events dispatched to EPAs
+ * @param       path
+ *              Trace file path, the file is truncated.
+ * @return      Operation status
+ *  @retval     NERROR_NONE - recording has started
+ *  @retval     NERROR_NO_RESOURCE - file could not be created
+ * @api
+ */
+nerror netrace_record_start(const char * path);
+
+
+
+/**@brief       Stop recording and close the trace file
+ * @api
+ */
+void netrace_record_stop(void);
+
+
+
+/**@brief       Record an event which is about to be dispatched
+ * @details     This function is called by EPA dispatcher.
+ * @notapi
+ */
+void netrace_record(const struct nepa * epa, const struct nevent * event);
+
+/**@} *//*----------------------------------------------------------------*//**
+ * @name        Replay
+ * @{ *//*--------------------------------------------------------------------*/
+
+/**@brief       Open a trace file for replay
+ * @param       replay
+ *              Pointer to replay structure
+ * @param       path
+ *              Trace file path
+ * @param       epas
+ *              Array of EPAs which may receive replayed events. Recorded EPAs
+ *              are matched by registry name.
+ * @param       n_epas
+ *              Number of elements in @c epas array
+ * @return      Operation status
+ *  @retval     NERROR_NONE - trace is opened
+ *  @retval     NERROR_OBJECT_NFOUND - file could not be opened
+ *  @retval     NERROR_OBJECT_INVALID - file is not a trace file
+ * @api
+ */
+nerror netrace_replay_open(struct netrace_replay * replay, const char * path,
+        struct nepa * const * epas, size_t n_epas);
+
+
+
+/**@brief       Send all events from trace file to EPAs
+ * @param       replay
+ *              Pointer to replay structure
+ * @param       pace
+ *              Replay pacing, see @ref netrace_pace.
+ * @return      Operation status
+ *  @retval     NERROR_NONE - all events were replayed
+ *  @retval     NERROR_OBJECT_INVALID - trace file is corrupted
+ * @note        This function blocks until the end of file is reached, so it
+ *              should be called from a thread other than the one executing
+ *              @ref nthread_schedule.
+ * @api
+ */
+nerror netrace_replay_run(struct netrace_replay * replay,
+        enum netrace_pace pace);
+
+
+
+/**@brief       Close the trace file
+ * @api
+ */
+void netrace_replay_close(struct netrace_replay * replay);
+
+/**@} *//*------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of etrace.h
+ ******************************************************************************/
+#endif /* NEON_EP_ETRACE_H_ */
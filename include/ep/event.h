@@ -37,6 +37,7 @@
 #include "port/compiler.h"
 #include "port/core.h"
 #include "base/config.h"
+#include "base/error.h"
 
 /*===============================================================  MACRO's  ==*/
 
@@ -48,7 +49,11 @@
  *              consideration for recycle process.
  * @api
  */
+#if (CONFIG_EVENT_COMPACT == 1)
+#define NEVENT_ATTR_RESERVED            ((uint8_t)0x02u | NEVENT_ATTR_DYNAMIC)
+#else
 #define NEVENT_ATTR_RESERVED            ((int16_t)0x0f00 | NEVENT_ATTR_DYNAMIC)
+#endif
 
 /**@brief       Bit mask which defines a dynamic event
  * @details     When the bits defined in this bit mask are set the given event
@@ -56,7 +61,18 @@
  *              the event if it is not referenced by any EPA object.
  * @api
  */
+#if (CONFIG_EVENT_COMPACT == 1)
+#define NEVENT_ATTR_DYNAMIC             ((uint8_t)0x01u)
+#else
 #define NEVENT_ATTR_DYNAMIC             ((int16_t)0x00ff)
+#endif
+
+/**@brief       Storage index of an event which is not allocated from a
+ *              registered memory object
+ * @note        Used only when @ref CONFIG_EVENT_COMPACT is enabled.
+ * @api
+ */
+#define NEVENT_MEM_NONE                 ((uint8_t)0xffu)
 
 /**@brief       This macro defines limit for event reference counter
  * @api
@@ -108,6 +124,18 @@
 /**@brief       Initialization macro for an event
  * @api
  */
+#if (CONFIG_EVENT_COMPACT == 1)
+#define NEVENT_INITIALIZER(event_id, producer, size)                            \
+    {                                                                           \
+		NP_EVENT_SIGNATURE_INIT                                                 \
+        (event_id),                                                             \
+        0,                                                                      \
+        0,                                                                      \
+        NEVENT_MEM_NONE,                                                        \
+        NP_EVENT_PRODUCER_INIT(producer)                                        \
+        NP_EVENT_SIZE_INIT(size)                                                \
+    }
+#else
 #define NEVENT_INITIALIZER(event_id, producer, size)                            \
     {                                                                           \
 		NP_EVENT_SIGNATURE_INIT                                                 \
@@ -118,6 +146,7 @@
         NP_EVENT_PRODUCER_INIT(producer)                                        \
         NP_EVENT_SIZE_INIT(size)                                                \
     }
+#endif
 
 
 /*------------------------------------------------------  C++ extern base  --*/
@@ -137,14 +166,26 @@ struct nepa;
  * @note        You may use @ref CONFIG_EVENT_STRUCT_ATTRIBUTE in
  *              @ref neon_eds_app_config.h file to configure additional compiler
  *              directives for this structure.
+ * @note        When @ref CONFIG_EVENT_COMPACT is enabled the memory object is
+ *              referenced by its index in event storage and reference counter
+ *              is 16-bit wide.
  * @api
  */
+#if (CONFIG_EVENT_COMPACT == 1)
+struct CONFIG_EVENT_STRUCT_ATTRIBUTE nevent {
+	NSIGNATURE_DECLARE                  /**<@brief Event signature            */
+    uint16_t                    id;     /**<@brief Event ID number            */
+    uint16_t                    ref;    /**<@brief Reference counter          */
+    uint8_t                     attrib; /**<@brief Dynamic attributes         */
+    uint8_t                     mem;    /**<@brief Memory storage index       */
+#else
 struct CONFIG_EVENT_STRUCT_ATTRIBUTE nevent {
 	NSIGNATURE_DECLARE                  /**<@brief Event signature            */
 	struct nmem *               mem;    /**<@brief Memory object              */
     uint_fast16_t               id;     /**<@brief Event ID number            */
     int_fast16_t                attrib; /**<@brief Dynamic attributes         */
     struct ncore_atomic         ref;    /**<@brief Reference counter          */
+#endif
 #if (CONFIG_EVENT_PRODUCER == 1) || defined(__DOXYGEN__)
                                         /**<@brief Event producer             */
     struct nepa *               producer;
@@ -160,6 +201,24 @@ struct CONFIG_EVENT_STRUCT_ATTRIBUTE nevent {
  */
 typedef struct nevent nevent;
 
+#if (CONFIG_EVENT_RESERVE == 1) || defined(__DOXYGEN__)
+/**@brief       Event storage reserved in advance
+ * @details     All elements of this structure are private members.
+ * @api
+ */
+struct nevent_reservation
+{
+    struct nmem *               mem;
+    void *                      storage;
+    size_t                      size;
+};
+
+/**@brief       Event reservation type
+ * @api
+ */
+typedef struct nevent_reservation nevent_reservation;
+#endif
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 
 extern const struct nevent      g_default_event;
@@ -184,9 +243,40 @@ void nevent_register_mem(struct nmem * mem);
  * @brief       Unregister a memory object
  * @param       mem
  *              Memory object
+ * @return      Operation status
+ *  @retval     NERROR_NONE - memory object is unregistered
+ *  @retval     NERROR_NOT_PERMITTED - events allocated from the memory object
+ *              are still alive, used only when @ref CONFIG_EVENT_COMPACT is
+ *              enabled
+ * @api
+ */
+nerror nevent_unregister_mem(struct nmem * mem);
+
+#if (CONFIG_EVENT_RESERVE == 1) || defined(__DOXYGEN__)
+/**
+ * @brief       Set a reserve of registered memory object
+ * @param       mem
+ *              Memory object which was registered for event storage
+ * @param       watermark
+ *              Free bytes of the memory object which are kept in reserve, 0
+ *              removes the reserve
+ * @param       min_priority
+ *              Minimum priority of EPA which may allocate from the reserve
+ * @details     When an allocation would leave less than @c watermark free
+ *              bytes only EPAs of priority @c min_priority or higher may
+ *              create events. Events created outside of EPA dispatch, by
+ *              interrupts or by other threads of the port, have priority 0.
+ *              Reserved creation functions and reservations may always use
+ *              the reserve, so control events get through under overload.
+ *              When the reserve refuses a producer the I-class creators
+ *              return NULL, the same as when the memory is exhausted.
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_EVENT_RESERVE must be enabled.
  * @api
  */
-void nevent_unregister_mem(struct nmem * mem);
+void nevent_set_reserve(struct nmem * mem, size_t watermark,
+        uint8_t min_priority);
+#endif
 
 /**@} *//*----------------------------------------------------------------*//**
  * @name        Event creation / deletion
@@ -219,7 +309,8 @@ struct nevent * nevent_create(
  * @param       id
  *              Event identification
  * @return      Pointer to new event
- * @retval      - NULL - No available memory storage
+ * @retval      - NULL - No available memory storage or the storage reserve
+ *              refused the caller, see @ref nevent_set_reserve
  * @iclass
  */
 struct nevent * nevent_create_i(
@@ -246,6 +337,81 @@ struct nevent * nevent_create_from_i(
 
 
 
+#if (CONFIG_EVENT_RESERVE == 1) || defined(__DOXYGEN__)
+/**@brief       Create an event which may use the storage reserve
+ * @details     See @ref nevent_create and @ref nevent_set_reserve.
+ * @api
+ */
+struct nevent * nevent_create_reserved(
+    size_t                      size,
+    uint16_t                    id);
+
+
+
+/**@brief       Create an event which may use the storage reserve
+ * @details     See @ref nevent_create_i and @ref nevent_set_reserve.
+ * @iclass
+ */
+struct nevent * nevent_create_reserved_i(
+    size_t                      size,
+    uint16_t                    id);
+
+
+
+/**@brief       Reserve storage for an event which will be created later
+ * @param       reservation
+ *              Pointer to reservation structure
+ * @param       size
+ *              The size of event in bytes
+ * @return      Operation status
+ *  @retval     NERROR_NONE - storage is reserved
+ *  @retval     NERROR_NO_MEMORY - no available memory storage
+ * @details     Storage is taken from event storage, including its reserve,
+ *              so a following @ref nevent_commit can not fail. The
+ *              reservation must be either committed or cancelled.
+ * @iclass
+ */
+nerror nevent_reserve_i(
+    struct nevent_reservation * reservation,
+    size_t                      size);
+
+
+
+/**@brief       Reserve storage for an event which will be created later
+ * @details     See @ref nevent_reserve_i.
+ * @api
+ */
+nerror nevent_reserve(
+    struct nevent_reservation * reservation,
+    size_t                      size);
+
+
+
+/**@brief       Create an event from reserved storage
+ * @param       reservation
+ *              Pointer to reservation structure
+ * @param       id
+ *              Event identification
+ * @return      Pointer to new event
+ * @api
+ */
+struct nevent * nevent_commit(
+    struct nevent_reservation * reservation,
+    uint16_t                    id);
+
+
+
+/**@brief       Return reserved storage
+ * @param       reservation
+ *              Pointer to reservation structure
+ * @api
+ */
+void nevent_cancel(
+    struct nevent_reservation * reservation);
+#endif
+
+
+
 /**@brief       Destroy an event
  * @param       event
  *              Pointer to the event.
@@ -274,6 +440,33 @@ struct nevent * nevent_forward(
     const struct nevent *       event,
     uint16_t                    id);
 
+
+
+/**@brief       Reuse the event which is being processed for a reply
+ * @param       event
+ *              Pointer to the event which is being processed.
+ * @param       id
+ *              Event identification of the reply.
+ * @return      Pointer to reply event
+ * @retval      - NULL - No available memory storage
+ * @details     When the caller holds the only reference to a dynamic event the
+ *              same event block is returned with new id and producer set, so
+ *              the reply does not pass through event storage. Otherwise a copy
+ *              is made using @ref nevent_forward. The returned event is then
+ *              sent as any other event:
+ * @code
+ * reply = nevent_recycle(event, RESPONSE);
+ * nepa_send_event(reply_epa, reply);
+ * @endcode
+ * @note        Call this function only from the state handler which is
+ *              processing @c event, the dispatcher then keeps the event alive
+ *              because it was sent again.
+ * @api
+ */
+struct nevent * nevent_recycle(
+    const struct nevent *       event,
+    uint16_t                    id);
+
 /**@} *//*----------------------------------------------------------------*//**
  * @name        Event reservation
  * @brief       Event reservation methods provide a way to prevent events 
@@ -310,10 +503,24 @@ PORT_C_INLINE
 void nevent_ref_up(const struct nevent * event)
 {
     if (event->attrib) {
+#if (CONFIG_EVENT_COMPACT == 1) && defined(__GNUC__)
+        /* NOTE:
+         * Cast away const qualifier
+         */
+        __atomic_add_fetch(&((struct nevent *)event)->ref, 1u,
+            __ATOMIC_RELAXED);
+#elif (CONFIG_EVENT_COMPACT == 1)
+        ncore_lock              lock;
+
+        ncore_lock_enter(&lock);
+        ((struct nevent *)event)->ref++;
+        ncore_lock_exit(&lock);
+#else
         /* NOTE:
          * Cast away const qualifier
          */
         ncore_atomic_inc(&((struct nevent *)event)->ref);
+#endif
     }
 }
 
@@ -327,15 +534,43 @@ PORT_C_INLINE
 void nevent_ref_down(const struct nevent * event)
 {
     if (event->attrib) {
+#if (CONFIG_EVENT_COMPACT == 1) && defined(__GNUC__)
+        /* NOTE:
+         * Cast away const qualifier
+         */
+        __atomic_sub_fetch(&((struct nevent *)event)->ref, 1u,
+            __ATOMIC_ACQ_REL);
+#elif (CONFIG_EVENT_COMPACT == 1)
+        ncore_lock              lock;
+
+        ncore_lock_enter(&lock);
+        ((struct nevent *)event)->ref--;
+        ncore_lock_exit(&lock);
+#else
         /* NOTE:
          * Cast away const qualifier
          */
         ncore_atomic_dec(&((struct nevent *)event)->ref);
+#endif
     }
 }
 
 
 
+/**@brief       Returns the raw reference counter value of an event
+ * @notapi
+ */
+#if (CONFIG_EVENT_COMPACT == 1) && defined(__GNUC__)
+#define np_event_ref_count(event)                                               \
+    __atomic_load_n(&(event)->ref, __ATOMIC_ACQUIRE)
+#elif (CONFIG_EVENT_COMPACT == 1)
+#define np_event_ref_count(event)       ((event)->ref)
+#else
+#define np_event_ref_count(event)       ncore_atomic_read(&(event)->ref)
+#endif
+
+
+
 /**@brief       Returns the reference counter value of a dynamic event
  * @note        If a constant event is given then the returned value will be a
  *              non-zero value in order to prevent event deletion.
@@ -346,7 +581,7 @@ void nevent_ref_down(const struct nevent * event)
 PORT_C_INLINE
 int_fast16_t nevent_ref(const struct nevent * event)
 {
-    return (ncore_atomic_read(&event->ref) | (event->attrib ^ NEVENT_ATTR_DYNAMIC));
+    return (np_event_ref_count(event) | (event->attrib ^ NEVENT_ATTR_DYNAMIC));
 }
 
 
@@ -0,0 +1,225 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       State machine array header
+ * @defgroup    eds_smarray State machine array
+ * @brief       State machine array
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     eds_smarray
+@section        smarray_layout Instance layout
+
+A state machine array runs many instances of the same state machine. The
+current state of all instances is kept in a single array and instance data is
+kept in columns owned by the application:
+
+@code
+struct conn_columns
+{
+    uint32_t                    rx_count[N_CONN];
+    uint8_t                     retries[N_CONN];
+};
+
+static nstate *                 conn_state[N_CONN];
+static struct conn_columns      conn_data;
+static struct nsm_array         conn;
+
+nsm_array_init(&conn, conn_state, N_CONN, state_idle, NSM_TYPE_FSM,
+    &conn_data);
+nsm_array_start(&conn);
+@endcode
+
+State functions are called with a machine shared by all instances, the
+instance being dispatched is returned by @ref nsm_array_instance:
+
+@code
+static naction state_idle(struct nsm * sm, const struct nevent * event)
+{
+    struct conn_columns * data = nsm_wspace(sm);
+    uint32_t              idx  = nsm_array_instance(sm);
+
+    data->rx_count[idx]++;
+    ...
+}
+@endcode
+
+The array is owned by a single EPA, which dispatches events to instances using
+@ref nsm_array_dispatch or @ref nsm_array_broadcast from its own state
+machine. When the array uses a table generated by scripts/gen_sm_table.py the
+transition lookup for a whole batch is done first in a loop without function
+calls, and instances which ignore the event are never dispatched.
+*/
+
+#ifndef NEON_EP_SMARRAY_H_
+#define NEON_EP_SMARRAY_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "port/compiler.h"
+#include "base/config.h"
+#include "base/debug.h"
+#include "ep/smp.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Validate the pointer to state machine array object
+ * @note        This macro may be used only when @ref CONFIG_API_VALIDATION
+ *              macro is enabled.
+ * @api
+ */
+#if (CONFIG_API_VALIDATION == 1) || defined(__DOXYGEN__)
+#define N_IS_SM_ARRAY_OBJECT(array_obj)                                         \
+    (NSIGNATURE_OF(array_obj) == NSIGNATURE_SM_ARRAY)
+#else
+#define N_IS_SM_ARRAY_OBJECT(array_obj) (array_obj)
+#endif
+
+/**@brief       Get the index of instance which is being dispatched
+ * @param       sm
+ *              State machine pointer given to a state function
+ * @api
+ */
+#define nsm_array_instance(sm)                                                  \
+    (PORT_C_CONTAINER_OF(sm, struct nsm_array, sm)->current)
+
+/*-------------------------------------------------------  C++ extern base  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+struct nevent;
+
+/**@brief       State machine array
+ * @details     All elements of this structure are private members.
+ * @api
+ */
+struct nsm_array
+{
+    NSIGNATURE_DECLARE
+    struct nsm                  sm;     /**<@brief Shared machine         */
+    uint32_t                    n;      /**<@brief Number of instances    */
+    uint32_t                    current;/**<@brief Dispatched instance    */
+    nstate **                   state;  /**<@brief State of instances     */
+#if (CONFIG_SMP_TABLE == 1) || defined(__DOXYGEN__)
+                                        /**<@brief Table state of instances*/
+    uint16_t *                  table_state;
+#endif
+};
+
+/**@brief       State machine array type
+ * @api
+ */
+typedef struct nsm_array nsm_array;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+/**@brief       Initialize array of state function driven machines
+ * @param       array
+ *              Pointer to array structure
+ * @param       state
+ *              Array of @c n elements which holds current state of instances
+ * @param       n
+ *              Number of instances
+ * @param       init_state
+ *              Initial state of all instances
+ * @param       type
+ *              Type of state machine, see @ref nsm_type
+ * @param       wspace
+ *              Instance data columns, returned by nsm_wspace()
+ * @api
+ */
+void nsm_array_init(struct nsm_array * array, nstate ** state, uint32_t n,
+        nstate * init_state, enum nsm_type type, void * wspace);
+
+
+
+#if (CONFIG_SMP_TABLE == 1) || defined(__DOXYGEN__)
+/**@brief       Initialize array of table driven machines
+ * @param       array
+ *              Pointer to array structure
+ * @param       table_state
+ *              Array of @c n elements which holds current state of instances
+ * @param       n
+ *              Number of instances
+ * @param       table
+ *              Table generated by scripts/gen_sm_table.py
+ * @param       wspace
+ *              Instance data columns, returned by nsm_wspace()
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_SMP_TABLE must be enabled.
+ * @api
+ */
+void nsm_array_init_table(struct nsm_array * array, uint16_t * table_state,
+        uint32_t n, const struct nsm_table * table, void * wspace);
+#endif
+
+
+
+/**@brief       Dispatch @ref NSM_INIT event to all instances
+ * @api
+ */
+void nsm_array_start(struct nsm_array * array);
+
+
+
+/**@brief       Dispatch a batch of events
+ * @param       array
+ *              Pointer to array structure
+ * @param       instance
+ *              Array of instance indexes
+ * @param       event
+ *              Array of events, event[i] is dispatched to instance[i]
+ * @param       count
+ *              Number of events in the batch
+ * @details     Events are dispatched in the given order, an instance may
+ *              appear more than once in a batch.
+ * @api
+ */
+void nsm_array_dispatch(struct nsm_array * array, const uint32_t * instance,
+        const struct nevent * const * event, size_t count);
+
+
+
+/**@brief       Dispatch an event to all instances
+ * @api
+ */
+void nsm_array_broadcast(struct nsm_array * array,
+        const struct nevent * event);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of smarray.h
+ ******************************************************************************/
+#endif /* NEON_EP_SMARRAY_H_ */
@@ -33,10 +33,12 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include "port/compiler.h"
 #include "base/config.h"
 #include "base/debug.h"
+#include "base/error.h"
 
 /*===============================================================  MACRO's  ==*/
 
@@ -179,6 +181,14 @@
 #define naction_transit_to(sm, state_ptr)                                       \
     ((sm)->state = (state_ptr), NACTION_TRANSIT_TO)
 
+/**
+ * @brief       Table state index which denotes no state
+ * @details     Used as parent of top level states, as initial sub-state of
+ *              leaf states and as target of internal transitions.
+ * @api
+ */
+#define NSM_TABLE_NONE                  UINT16_MAX
+
 /*-------------------------------------------------------  C++ extern base  --*/
 #ifdef __cplusplus
 extern "C" {
@@ -257,6 +267,69 @@ typedef enum naction naction;
  */
 typedef naction  (nstate) (struct nsm *, const struct nevent *);
 
+#if (CONFIG_SMP_TABLE == 1) || defined(__DOXYGEN__)
+/**
+ * @brief       Table state machine action prototype
+ * @details     Used for transition actions and for state entry and exit
+ *              actions.
+ * @api
+ */
+typedef void (nsm_table_action) (struct nsm *, const struct nevent *);
+
+/**
+ * @brief       Table state machine guard prototype
+ * @return      When false the transition is not taken and the transition of
+ *              the first enclosing state handling the same event is tried.
+ * @api
+ */
+typedef bool (nsm_table_guard) (struct nsm *, const struct nevent *);
+
+/**
+ * @brief       Table state descriptor
+ * @api
+ */
+struct nsm_table_state
+{
+    uint16_t                    parent; /**<@brief Index of super state       */
+    uint16_t                    init;   /**<@brief Index of initial sub-state */
+    nsm_table_action *          entry;  /**<@brief Entry action or NULL       */
+    nsm_table_action *          exit;   /**<@brief Exit action or NULL        */
+};
+
+/**
+ * @brief       Table transition descriptor
+ * @api
+ */
+struct nsm_table_transition
+{
+    nsm_table_guard *           guard;  /**<@brief Guard or NULL              */
+    nsm_table_action *          action; /**<@brief Action or NULL             */
+    uint16_t                    target; /**<@brief Target state index         */
+    uint16_t                    lca;    /**<@brief Exit states up to this one */
+    uint16_t                    next;   /**<@brief Tried when guard fails     */
+};
+
+/**
+ * @brief       Table state machine description
+ * @details     This structure is generated by scripts/gen_sm_table.py script.
+ *              Element @c map has @c n_states * @c n_events elements, each
+ *              element is an index into @c transition array or
+ *              @ref NSM_TABLE_NONE when the event is ignored in the state.
+ * @api
+ */
+struct nsm_table
+{
+    const struct nsm_table_state *      state;
+    const struct nsm_table_transition * transition;
+    const uint16_t *                    map;
+    uint16_t                            n_states;
+    uint16_t                            n_events;
+    uint16_t                            event_base;
+                                        /**<@brief Initial top level state    */
+    uint16_t                            initial;
+};
+#endif
+
 /**
  * @brief       State machine structure
  * @api
@@ -271,6 +344,11 @@ struct nsm
     void                     (* vf_dispatch)(struct nsm *, const struct nevent *);
     nstate *                    state;  /**<@brief Current state              */
     void *                      wspace;
+#if (CONFIG_SMP_TABLE == 1) || defined(__DOXYGEN__)
+    const struct nsm_table *    table;  /**<@brief State machine table        */
+    uint_fast16_t               table_state;
+                                        /**<@brief Current table state index  */
+#endif
 };
 
 /**
@@ -303,6 +381,53 @@ struct nsm * nsm_alloc(struct nmem * mem, size_t wspace_size,
 void nsm_free(struct nsm * sm);
 #endif
 
+#if (CONFIG_SMP_HSM_HANDLER_CACHE != 0u) || defined(__DOXYGEN__)
+/**
+ * @brief       Declare which events are handled by a HSM state
+ * @param       state
+ *              State function
+ * @param       ids
+ *              Array of event ids sorted in ascending order. The array must
+ *              remain valid while the state is in use.
+ * @param       n_ids
+ *              Number of elements in @c ids array
+ * @return      Operation status
+ *  @retval     NERROR_NONE - declaration is stored
+ *  @retval     NERROR_NO_RESOURCE - state cache is full, see
+ *              @ref CONFIG_SMP_HSM_STATE_CACHE
+ * @details     HSM dispatcher does not call the state with events which are
+ *              not declared, but passes them directly to the first super
+ *              state which may handle them. Events which are not handled by
+ *              any state are dropped without calling the states. States which
+ *              did not declare their events are called with all events.
+ * @note        The state must return naction_super() for every event which is
+ *              not declared.
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_SMP_HSM_HANDLER_CACHE must be enabled.
+ * @api
+ */
+nerror nsm_state_handles(nstate * state, const uint16_t * ids, size_t n_ids);
+#endif
+
+#if (CONFIG_SMP_TABLE == 1) || defined(__DOXYGEN__)
+/**
+ * @brief       Attach a generated table to state machine
+ * @param       sm
+ *              Pointer to state machine, usually initialized by
+ *              @ref NSM_BUNDLE_STRUCT_INIT or belonging to an EPA bundle with
+ *              NULL initial state.
+ * @param       table
+ *              Table generated by scripts/gen_sm_table.py
+ * @details     The state machine enters its initial state when
+ *              @ref NSM_INIT event is dispatched, which EPA does when it is
+ *              started. Call this function before EPA is scheduled.
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_SMP_TABLE must be enabled.
+ * @api
+ */
+void nsm_table_init(struct nsm * sm, const struct nsm_table * table);
+#endif
+
 /**
  * @brief       Dispatch a state machine
  * @api
@@ -337,6 +462,14 @@ void n_sm_hsm_dispatch(struct nsm * sm, const struct nevent * event);
  */
 void n_sm_fsm_dispatch(struct nsm * sm, const struct nevent * event);
 
+#if (CONFIG_SMP_TABLE == 1) || defined(__DOXYGEN__)
+/**
+ * @brief       Table state machine dispatch function
+ * @notapi
+ */
+void n_sm_table_dispatch(struct nsm * sm, const struct nevent * event);
+#endif
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
@@ -0,0 +1,157 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Arena memory management
+ * @defgroup    mm_arena Arena memory management
+ * @brief       Arena memory management
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     mm_arena
+@section        arena_usage Usage
+
+Arena is a bump allocator. Allocation only moves the arena cursor forward, so
+it takes a few instructions and does not use the core lock. Objects are never
+freed one by one, instead the whole arena, or everything allocated after a
+mark, is released at once:
+
+@code
+static NARENA_BUNDLE_DEFINE(parse_arena, 4096);
+
+struct nmem * arena = NARENA_FROM_BUNDLE(&parse_arena);
+size_t        mark  = narena_mark(arena);
+
+token = narena_alloc(arena, sizeof(*token));
+...
+narena_release(arena, mark);
+@endcode
+
+Allocation may be called concurrently from any thread. Mark, release and reset
+must not run concurrently with allocations from the same arena, they are meant
+to be called by the owner of the arena between two units of work.
+
+The arena may also be used through @ref nmem_alloc. Calling @ref nmem_free on
+arena memory is allowed and does nothing.
+*/
+
+#ifndef NEON_MM_ARENA_H_
+#define NEON_MM_ARENA_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+
+#include "base/debug.h"
+#include "mm/mem.h"
+
+/*===============================================================  MACRO's  ==*/
+
+#define NARENA_BUNDLE_STRUCT(name, size)                                    \
+    NMEM_BUNDLE_STRUCT(name, size)
+
+#define NARENA_BUNDLE_STRUCT_INIT(instance)                                 \
+    NMEM_BUNDLE_STRUCT_INIT(instance, 1, arena_init_alloc, NSIGNATURE_ARENA)
+
+#define NARENA_BUNDLE_DEFINE(name, size)                                    \
+    NARENA_BUNDLE_STRUCT(name, size) name =                                 \
+        NARENA_BUNDLE_STRUCT_INIT(name)
+
+#define NARENA_FROM_BUNDLE(instance)    NMEM_FROM_BUNDLE(instance)
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+void * arena_init_alloc(struct nmem * arena_obj, size_t size);
+
+
+
+/**@brief       Initialize an arena in the given storage
+ * @param       arena_obj
+ *              Pointer to memory object
+ * @param       storage
+ *              Arena storage, aligned to @ref NCPU_DATA_ALIGNMENT
+ * @param       size
+ *              Size of storage in bytes
+ * @details     Use this function for arenas which are not defined by
+ *              @ref NARENA_BUNDLE_DEFINE.
+ * @api
+ */
+void narena_init(struct nmem * arena_obj, void * storage, size_t size);
+
+
+
+/**@brief       Allocate memory from arena
+ * @param       arena_obj
+ *              Pointer to arena memory object
+ * @param       size
+ *              Size of memory in bytes
+ * @return      Pointer to allocated memory, aligned to
+ *              @ref NCPU_DATA_ALIGNMENT
+ *  @retval     NULL - arena is exhausted
+ * @note        The function does not take the core lock.
+ * @api
+ */
+void * narena_alloc(struct nmem * arena_obj, size_t size);
+
+
+
+/**@brief       Get the current position of arena cursor
+ * @return      Mark which can be given to @ref narena_release
+ * @api
+ */
+size_t narena_mark(struct nmem * arena_obj);
+
+
+
+/**@brief       Release all memory allocated after the mark was taken
+ * @param       arena_obj
+ *              Pointer to arena memory object
+ * @param       mark
+ *              Value returned by @ref narena_mark
+ * @api
+ */
+void narena_release(struct nmem * arena_obj, size_t mark);
+
+
+
+/**@brief       Release all memory allocated from arena
+ * @api
+ */
+void narena_reset(struct nmem * arena_obj);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of arena.h
+ ******************************************************************************/
+#endif /* NEON_MM_ARENA_H_ */
@@ -0,0 +1,151 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Elastic pool memory management
+ * @defgroup    mm_epool Elastic pool memory management
+ * @brief       Elastic pool memory management
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     mm_epool
+@section        epool_growth Growth
+
+An elastic pool allocates fixed size blocks like a pool, but it does not need
+its storage up front. When the pool is exhausted it allocates another chunk of
+blocks from a parent memory object, which may be a heap, huge page memory or
+standard heap:
+
+@code
+static struct nepool            g_event_pool;
+
+nepool_init(&g_event_pool, NHEAP_FROM_BUNDLE(&g_heap), 64u, 32u, 1024u);
+event = nmem_alloc(&g_event_pool.mem_class, 64u);
+@endcode
+
+Each chunk holds @c grow blocks and the pool never holds more than
+@c max_blocks blocks. Allocation and deallocation of blocks take constant
+time, chunks are never returned to the parent during normal operation. A
+chunk whose blocks are all free is returned to the parent by
+@ref nepool_trim, except the first one, so an application may call it when a
+spike of load is over.
+*/
+
+#ifndef NEON_MM_EPOOL_H_
+#define NEON_MM_EPOOL_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/config.h"
+#include "mm/mem.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Elastic pool is not limited in number of blocks
+ * @api
+ */
+#define NEPOOL_NO_LIMIT                 0u
+
+/*-------------------------------------------------------  C++ extern base  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+struct nepool_chunk;
+
+/**@brief       Elastic pool memory object structure
+ * @details     All elements of this structure are private members.
+ * @api
+ */
+struct nepool
+{
+    struct nmem                 mem_class;
+    struct nmem *               parent;
+    struct nepool_chunk *       chunks;     /**<@brief Oldest chunk last  */
+    size_t                      block_size;
+    uint32_t                    grow;       /**<@brief Blocks in a chunk  */
+    uint32_t                    max_blocks;
+};
+
+/**@brief       Elastic pool memory object type
+ * @api
+ */
+typedef struct nepool nepool;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+/**@brief       Initialize elastic pool memory object
+ * @param       epool
+ *              Pointer to elastic pool memory object
+ * @param       parent
+ *              Memory object which provides chunks
+ * @param       block_size
+ *              Size of a block in bytes
+ * @param       grow
+ *              Number of blocks allocated at once from parent
+ * @param       max_blocks
+ *              Maximum number of blocks, or @ref NEPOOL_NO_LIMIT
+ * @details     No memory is allocated from parent until the first block is
+ *              allocated.
+ * @api
+ */
+void nepool_init(struct nepool * epool, struct nmem * parent,
+        size_t block_size, uint32_t grow, uint32_t max_blocks);
+
+
+
+/**@brief       Return idle chunks to parent memory object
+ * @param       epool
+ *              Pointer to elastic pool memory object
+ * @return      Number of chunks returned to parent
+ * @details     A chunk is idle when all of its blocks are free. The first
+ *              allocated chunk is always kept. This function walks all free
+ *              blocks, so it should be called when the application is idle.
+ * @iclass
+ */
+uint32_t nepool_trim_i(struct nepool * epool);
+
+
+
+/**@brief       Return idle chunks to parent memory object
+ * @details     See @ref nepool_trim_i.
+ * @api
+ */
+uint32_t nepool_trim(struct nepool * epool);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of epool.h
+ ******************************************************************************/
+#endif /* NEON_MM_EPOOL_H_ */
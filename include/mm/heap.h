@@ -62,6 +62,22 @@ extern "C" {
 
 void * heap_init_alloc(struct nmem * mem_obj, size_t size);
 
+
+
+/**@brief       Initialize a heap in the given storage
+ * @param       heap_obj
+ *              Pointer to memory object
+ * @param       storage
+ *              Heap storage, aligned to @ref NCPU_DATA_ALIGNMENT
+ * @param       size
+ *              Size of storage in bytes
+ * @details     Use this function for heaps which are not defined by
+ *              @ref NHEAP_BUNDLE_DEFINE, for example when the storage is
+ *              allocated from another memory object.
+ * @api
+ */
+void nheap_init(struct nmem * heap_obj, void * storage, size_t size);
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
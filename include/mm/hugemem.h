@@ -0,0 +1,150 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Huge page memory header
+ * @defgroup    mm_hugemem Huge page memory
+ * @brief       Huge page memory
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     mm_hugemem
+@section        hugemem_usage Usage
+
+Huge page memory maps a large anonymous region with huge pages and manages it
+with the TLSF allocator. Heaps, pools and slabs of an application are then
+carved from the region, so a large working set needs only a few TLB entries.
+The region in the example below needs @ref CONFIG_TLSF_MAX_SIZE_BITS of at
+least 29, the default TLSF limit is 16MB:
+
+@code
+static struct nhugemem          g_huge;
+static struct nmem              g_event_pool;
+
+nhugemem_init(&g_huge, 256ul * 1024ul * 1024ul, 0);
+storage = nmem_alloc(&g_huge.mem_class, NPOOL_COMPUTE_SIZE(N_EVENTS, 64u));
+npool_init(&g_event_pool, storage, 64u, N_EVENTS);
+@endcode
+
+The region is first mapped from the kernel huge page pool (MAP_HUGETLB). When
+no huge pages are reserved the region is mapped with normal pages and marked
+for transparent huge pages instead, see @ref nhugemem_is_hugetlb. The region
+may be bound to a NUMA node, so all its pages are allocated from the memory of
+that node.
+
+The region size must fit in the TLSF allocator, see
+@ref CONFIG_TLSF_MAX_SIZE_BITS. On 64 bit targets the option may be raised above
+31, so regions larger than 2GB may be used.
+*/
+
+#ifndef NEON_MM_HUGEMEM_H_
+#define NEON_MM_HUGEMEM_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "base/config.h"
+#include "base/error.h"
+#include "mm/mem.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Do not bind huge page memory to a NUMA node
+ * @api
+ */
+#define NHUGEMEM_ANY_NODE               (-1)
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Huge page memory object structure
+ * @details     Memory is allocated through @a mem_class member. Other members
+ *              are private.
+ * @api
+ */
+struct nhugemem
+{
+    struct nmem                 mem_class;
+    void *                      region; /**<@brief Mapped region            */
+    size_t                      region_size;
+    bool                        is_hugetlb;
+};
+
+/**@brief       Huge page memory object type
+ * @api
+ */
+typedef struct nhugemem nhugemem;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+/**@brief       Map a huge page memory region
+ * @param       huge_obj
+ *              Pointer to huge page memory object
+ * @param       size
+ *              Size of region in bytes, rounded up to
+ *              @ref CONFIG_HUGEMEM_PAGE_SIZE
+ * @param       node
+ *              NUMA node of region memory, or @ref NHUGEMEM_ANY_NODE
+ * @return      Operation status
+ *  @retval     NERROR_NONE - region is mapped
+ *  @retval     NERROR_NO_MEMORY - region can not be mapped
+ *  @retval     NERROR_ARG_INVALID - region is too large for the TLSF
+ *              allocator or it can not be bound to the node
+ * @api
+ */
+nerror nhugemem_init(struct nhugemem * huge_obj, size_t size, int node);
+
+
+
+/**@brief       Unmap huge page memory region
+ * @details     All memory objects carved from the region become invalid.
+ * @api
+ */
+void nhugemem_term(struct nhugemem * huge_obj);
+
+
+
+/**@brief       Is the region mapped from the kernel huge page pool?
+ * @return      When false the region uses transparent huge pages, if they are
+ *              enabled in the kernel.
+ * @api
+ */
+bool nhugemem_is_hugetlb(const struct nhugemem * huge_obj);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of hugemem.h
+ ******************************************************************************/
+#endif /* NEON_MM_HUGEMEM_H_ */
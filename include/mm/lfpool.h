@@ -0,0 +1,149 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Lock-free pool memory management
+ * @defgroup    mm_lfpool Lock-free pool memory management
+ * @brief       Lock-free pool memory management
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     mm_lfpool
+@section        lfpool_usage Usage
+
+Lock-free pool is a fixed block pool which may be used from any thread without
+taking the core lock. Free blocks are kept on a stack whose head holds a block
+index together with a version counter. Every pop changes the version, so a
+thread which was preempted between reading and replacing the head can not
+install a stale next pointer (the ABA problem).
+
+@code
+static NLFPOOL_BUNDLE_DEFINE(msg_pool, sizeof(struct msg), 256);
+
+struct msg * msg = nlfpool_alloc(NLFPOOL_FROM_BUNDLE(&msg_pool));
+...
+nlfpool_free(NLFPOOL_FROM_BUNDLE(&msg_pool), msg);
+@endcode
+
+When the port supports thread local variables each thread keeps a small cache
+of free blocks for each pool it uses, see @ref CONFIG_LFPOOL_CACHE. Blocks
+freed by a thread are reused by the same thread without touching the shared
+stack, and a full cache is returned to the stack as a single chain. Blocks in
+a cache are not available to other threads and are not counted as free, a
+thread which exits should call @ref nlfpool_cache_flush.
+
+The pool may also be used through @ref nmem_alloc and @ref nmem_free.
+*/
+
+#ifndef NEON_MM_LFPOOL_H_
+#define NEON_MM_LFPOOL_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+
+#include "base/bitop.h"
+#include "mm/mem.h"
+
+/*===============================================================  MACRO's  ==*/
+
+#define NLFPOOL_COMPUTE_SIZE(n_of_blocks, block_size)                       \
+    (sizeof(struct nlfpool_head) +                                          \
+     (n_of_blocks) * (NALIGN_UP(block_size, sizeof(uintptr_t))))
+
+#define NLFPOOL_BUNDLE_STRUCT(name, block_size, n_of_blocks)                \
+    NMEM_BUNDLE_STRUCT(name, NLFPOOL_COMPUTE_SIZE(n_of_blocks, block_size))
+
+#define NLFPOOL_BUNDLE_STRUCT_INIT(instance, n_of_blocks)                   \
+    NMEM_BUNDLE_STRUCT_INIT(instance, n_of_blocks, lfpool_init_alloc,       \
+        NSIGNATURE_LFPOOL)
+
+#define NLFPOOL_BUNDLE_DEFINE(name, block_size, n_of_blocks)                \
+    NLFPOOL_BUNDLE_STRUCT(name, block_size, n_of_blocks) name =             \
+        NLFPOOL_BUNDLE_STRUCT_INIT(name, n_of_blocks)
+
+#define NLFPOOL_FROM_BUNDLE(instance)   NMEM_FROM_BUNDLE(instance)
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       Lock-free pool stack head
+ * @details     All elements of this structure are private members. The head
+ *              is placed at the beginning of pool storage.
+ */
+struct nlfpool_head
+{
+    uintptr_t                   top;    /**<@brief Version and block index  */
+    uint8_t *                   blocks; /**<@brief First block              */
+    size_t                      block_size;
+};
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+void * lfpool_init_alloc(struct nmem * pool_obj, size_t size);
+
+
+
+/**@brief       Allocate a block from lock-free pool
+ * @param       pool_obj
+ *              Pointer to pool memory object
+ * @return      Pointer to allocated block
+ *  @retval     NULL - pool is empty
+ * @note        The function does not take the core lock.
+ * @api
+ */
+void * nlfpool_alloc(struct nmem * pool_obj);
+
+
+
+/**@brief       Return a block to lock-free pool
+ * @param       pool_obj
+ *              Pointer to pool memory object
+ * @param       mem
+ *              Pointer to previously allocated block
+ * @note        The function does not take the core lock.
+ * @api
+ */
+void nlfpool_free(struct nmem * pool_obj, void * mem);
+
+
+
+/**@brief       Return all blocks cached by the calling thread to their pools
+ * @api
+ */
+void nlfpool_cache_flush(void);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of lfpool.h
+ ******************************************************************************/
+#endif /* NEON_MM_LFPOOL_H_ */
@@ -32,8 +32,10 @@
 /*========================================================  INCLUDE FILES  ==*/
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "port/compiler.h"
+#include "base/config.h"
 #include "base/debug.h"
 
 /*==============================================================  MACRO's  ==*/
@@ -49,10 +51,23 @@
     (((mem_obj) != NULL) && ((NSIGNATURE_OF(mem_obj) == NSIGNATURE_STATIC)  \
         || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_HEAP)                      \
         || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_POOL)                      \
-        || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_STDHEAP)))
+        || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_STDHEAP)                   \
+        || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_TLSF)                      \
+        || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_LFPOOL)                    \
+        || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_SLAB)                      \
+        || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_ARENA)                     \
+        || (NSIGNATURE_OF(mem_obj) == NSIGNATURE_EPOOL)))
 
 #define NMEM_GENERIC_HEAP               nmem_get_generic_heap()
 
+/**
+ * @brief       Number of buckets in allocation size histogram
+ * @details     Bucket @c n counts requests from 2^n up to 2^(n + 1) - 1 bytes,
+ *              the last bucket counts all larger requests.
+ * @api
+ */
+#define NMEM_STATS_BUCKETS              16u
+
 /**
  * @brief       Macro to declare a memory allocator bundle structure
  * @param       name
@@ -112,10 +127,56 @@ extern "C" {
 
 /*===========================================================  DATA TYPES  ==*/
 
+/**
+ * @brief       Memory object statistics
+ * @details     Used and peak bytes are derived from free bytes of the memory
+ *              object, so they include the overhead of allocator. Members
+ *              @a free, @a largest_free and @a fragmentation are computed by
+ *              @ref nmem_get_stats. A successful reallocation is counted as a
+ *              free of the old block and an allocation of the new one.
+ * @api
+ */
+struct nmem_stats
+{
+    size_t                      used;   /**<@brief Used bytes                */
+    size_t                      peak;   /**<@brief Maximum of used bytes     */
+    size_t                      free;   /**<@brief Free bytes                */
+    size_t                      largest_free;
+                                        /**<@brief Largest free block        */
+    uint32_t                    fragmentation;
+                                        /**<@brief Free bytes outside of the */
+                                        /*         largest block, percent    */
+    uint32_t                    n_alloc;/**<@brief Successful allocations    */
+    uint32_t                    n_free; /**<@brief Frees                     */
+    uint32_t                    n_fail; /**<@brief Failed allocations        */
+                                        /**<@brief Requested size histogram  */
+    uint32_t                    histogram[NMEM_STATS_BUCKETS];
+};
+
+/**
+ * @brief       Allocation call site statistics
+ * @details     A site is the return address of function which called the
+ *              allocation API. When @ref nmem_alloc_i is inlined this is the
+ *              caller of the function which contains it. Use a debugger or
+ *              addr2line to get the source line.
+ * @api
+ */
+struct nmem_site
+{
+    const void *                site;   /**<@brief Call site address         */
+    const struct nmem *         mem;    /**<@brief Memory object             */
+    size_t                      bytes;  /**<@brief Requested bytes           */
+    uint32_t                    n_alloc;/**<@brief Successful allocations    */
+    uint32_t                    n_fail; /**<@brief Failed allocations        */
+};
+
 /**
  * @brief       Memory object structure
  * @details     The structure holds virtual function pointers and common
- *              information of all memory classes.
+ *              information of all memory classes. Aligned allocation,
+ *              reallocation and sized free pointers are optional, when a
+ *              memory class does not set them a generic implementation is
+ *              used.
  *
  *              If an allocator variant needs more memory for state variables
  *              it will allocate the memory from given storage.
@@ -130,11 +191,26 @@ struct nmem
     void *                   (* vf_alloc)(struct nmem *, size_t);
     /**@brief   Free VF pointer */
     void                     (* vf_free) (struct nmem *, void *);
+    /**@brief   Allocate aligned memory VF pointer, optional */
+    void *                   (* vf_alloc_aligned)(struct nmem *, size_t,
+                                                  size_t);
+    /**@brief   Reallocate VF pointer, optional */
+    void *                   (* vf_realloc)(struct nmem *, void *, size_t,
+                                            size_t);
+    /**@brief   Free memory of known size VF pointer, optional */
+    void                     (* vf_free_sized)(struct nmem *, void *, size_t);
     void *                      base;   /**<@brief Base address              */
+    void *                      cursor; /**<@brief Next never used block     */
     size_t                      free;   /**<@brief Free bytes                */
     size_t                      size;   /**<@brief Size of memory            */
     /**@brief   Number of blocks */
     uint32_t                    no_blocks;
+#if (CONFIG_MEM_STATS == 1) || defined(__DOXYGEN__)
+    /**@brief   Largest free block VF pointer, NULL when free memory is not
+     *          split into blocks of different size */
+    size_t                   (* vf_largest)(struct nmem *);
+    struct nmem_stats           stats;  /**<@brief Statistics                */
+#endif
     NSIGNATURE_DECLARE    				/**<@brief Memory object signature   */
 };
 
@@ -147,6 +223,29 @@ typedef struct nmem nmem;
 /*=====================================================  GLOBAL VARIABLES  ==*/
 /*==================================================  FUNCTION PROTOTYPES  ==*/
 
+/**
+ * @brief       Initialize common members of memory object whose storage is
+ *              given at run time
+ * @details     The memory class is set up by @a init_alloc function on first
+ *              allocation, the same as memory objects defined by
+ *              @ref NMEM_BUNDLE_STRUCT_INIT. The caller sets the signature.
+ */
+void n_mem_init(struct nmem * mem_obj,
+        void * (* init_alloc)(struct nmem *, size_t), void * storage,
+        size_t size, uint32_t no_blocks);
+
+
+
+#if (CONFIG_MEM_STATS == 1)
+void * n_mem_stats_alloc_i(struct nmem * mem_obj, size_t size,
+        const void * site);
+
+
+
+void n_mem_stats_free_i(struct nmem * mem_obj, void * mem_storage);
+#endif
+
+
 
 /**
  * @brief       Allocate memory from specified memory object
@@ -163,7 +262,15 @@ typedef struct nmem nmem;
 PORT_C_INLINE
 void * nmem_alloc_i(struct nmem * mem_obj, size_t size)
 {
+#if (CONFIG_MEM_STATS == 1)
+# if defined(PORT_C_RETURN_ADDRESS)
+    return (n_mem_stats_alloc_i(mem_obj, size, PORT_C_RETURN_ADDRESS()));
+# else
+    return (n_mem_stats_alloc_i(mem_obj, size, NULL));
+# endif
+#else
     return (mem_obj->vf_alloc(mem_obj, size));
+#endif
 }
 
 
@@ -214,7 +321,11 @@ void * nmem_zalloc(struct nmem * mem_obj, size_t size);
 PORT_C_INLINE
 void nmem_free_i(struct nmem * mem_obj, void * mem_storage)
 {
+#if (CONFIG_MEM_STATS == 1)
+    n_mem_stats_free_i(mem_obj, mem_storage);
+#else
     mem_obj->vf_free(mem_obj, mem_storage);
+#endif
 }
 
 
@@ -233,6 +344,94 @@ void nmem_free(struct nmem * mem_obj, void * mem_storage);
 
 
 
+/**
+ * @brief       Allocate aligned memory from specified memory object
+ * @param       mem_obj
+ *              Pointer to memory object
+ * @param       size
+ *              The size of requested memory in bytes
+ * @param       align
+ *              Alignment in bytes, a power of 2
+ * @return      The pointer to allocated memory
+ *              - @retval NULL - No available memory storage
+ * @details     Memory classes which do not implement aligned allocation can
+ *              only return memory aligned to @ref NCPU_DATA_ALIGNMENT, for
+ *              larger alignments NULL is returned.
+ * @iclass
+ */
+void * nmem_alloc_aligned_i(struct nmem * mem_obj, size_t size, size_t align);
+
+
+
+/**
+ * @brief       Allocate aligned memory from specified memory object
+ * @details     See @ref nmem_alloc_aligned_i.
+ * @api
+ */
+void * nmem_alloc_aligned(struct nmem * mem_obj, size_t size, size_t align);
+
+
+
+/**
+ * @brief       Change the size of allocated memory
+ * @param       mem_obj
+ *              Pointer to memory object
+ * @param       mem_storage
+ *              Pointer to previously allocated memory, or NULL
+ * @param       old_size
+ *              The size which was requested when the memory was allocated
+ * @param       new_size
+ *              The new size in bytes
+ * @return      The pointer to reallocated memory, it may be different than
+ *              @a mem_storage. The content is preserved up to the lesser of
+ *              the old and new sizes.
+ *              - @retval NULL - No available memory storage, the original
+ *                memory is not changed
+ * @details     Memory classes which can not resize memory in place allocate
+ *              new memory, copy the content and free the old memory.
+ * @iclass
+ */
+void * nmem_realloc_i(struct nmem * mem_obj, void * mem_storage,
+        size_t old_size, size_t new_size);
+
+
+
+/**
+ * @brief       Change the size of allocated memory
+ * @details     See @ref nmem_realloc_i.
+ * @api
+ */
+void * nmem_realloc(struct nmem * mem_obj, void * mem_storage,
+        size_t old_size, size_t new_size);
+
+
+
+/**
+ * @brief       Free the allocated memory of known size
+ * @param       mem_obj
+ *              Pointer to memory object
+ * @param       mem_storage
+ *              Pointer to previously allocated memory
+ * @param       size
+ *              The size which was requested when the memory was allocated
+ * @details     Static memory can release the most recent allocation only
+ *              with this function.
+ * @iclass
+ */
+void nmem_free_sized_i(struct nmem * mem_obj, void * mem_storage,
+        size_t size);
+
+
+
+/**
+ * @brief       Free the allocated memory of known size
+ * @details     See @ref nmem_free_sized_i.
+ * @api
+ */
+void nmem_free_sized(struct nmem * mem_obj, void * mem_storage, size_t size);
+
+
+
 /**
  * @brief       Return the number of free bytes in specified memory object
  * @param       mem_obj
@@ -267,6 +466,41 @@ size_t nmem_get_size(struct nmem * mem_obj)
 
 
 
+#if (CONFIG_MEM_STATS == 1) || defined(__DOXYGEN__)
+/**
+ * @brief       Get statistics of specified memory object
+ * @param       mem_obj
+ *              Pointer to memory object
+ * @param       stats
+ *              Pointer to structure which receives the statistics
+ * @details     Largest free block is searched for only in memory classes which
+ *              split free memory into blocks of different size (heap and
+ *              TLSF). In other classes it is equal to the number of free
+ *              bytes.
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_MEM_STATS must be enabled.
+ * @api
+ */
+void nmem_get_stats(struct nmem * mem_obj, struct nmem_stats * stats);
+
+
+
+/**
+ * @brief       Get statistics of allocation call sites
+ * @param       sites
+ *              Array which receives the statistics
+ * @param       n_sites
+ *              Number of elements in @a sites array
+ * @return      Number of call sites written to array
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_MEM_STATS must be enabled.
+ * @api
+ */
+size_t nmem_get_sites(struct nmem_site * sites, size_t n_sites);
+#endif
+
+
+
 PORT_C_INLINE
 void nmem_set_generic_heap(struct nmem * mem_obj)
 {
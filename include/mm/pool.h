@@ -63,6 +63,25 @@ extern "C" {
 
 void * pool_init_alloc(struct nmem * pool_obj, size_t size);
 
+
+
+/**@brief       Initialize a pool in the given storage
+ * @param       pool_obj
+ *              Pointer to memory object
+ * @param       storage
+ *              Pool storage of @ref NPOOL_COMPUTE_SIZE bytes
+ * @param       block_size
+ *              Size of a block in bytes
+ * @param       n_blocks
+ *              Number of blocks
+ * @details     Use this function for pools which are not defined by
+ *              @ref NPOOL_BUNDLE_DEFINE, for example when the storage is
+ *              allocated from another memory object.
+ * @api
+ */
+void npool_init(struct nmem * pool_obj, void * storage, size_t block_size,
+        uint32_t n_blocks);
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
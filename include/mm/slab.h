@@ -0,0 +1,192 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Slab memory management
+ * @defgroup    mm_slab Slab memory management
+ * @brief       Slab memory management
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     mm_slab
+@section        slab_caches Object caches
+
+Slab allocator serves objects of many types from a single backing memory
+object. Each object type gets a named cache with a fixed object size:
+
+@code
+static struct nslab             g_slab;
+static struct nslab_cache       g_epa_cache;
+static struct nslab_cache       g_event_cache;
+
+nslab_init(&g_slab, NTLSF_FROM_BUNDLE(&g_tlsf));
+nslab_cache_init(&g_slab, &g_epa_cache, "epa", sizeof(struct nepa));
+nslab_cache_init(&g_slab, &g_event_cache, "event", 64u);
+@endcode
+
+A cache carves objects from slabs of @ref CONFIG_SLAB_SIZE bytes which are
+allocated from the backing memory when needed. Each slab tracks its free
+objects in a bitmap. Objects are aligned to @ref CONFIG_SLAB_ALIGN bytes, and
+the space left over at the end of a slab is used to shift the first object of
+consecutive slabs by one alignment unit (coloring), so objects of different
+slabs do not compete for the same cache sets. A slab whose objects are all
+free is returned to the backing memory, except the last one of a cache.
+
+The slab object is also a memory object: @ref nmem_alloc returns an object
+from the smallest cache whose object size fits the request.
+*/
+
+#ifndef NEON_MM_SLAB_H_
+#define NEON_MM_SLAB_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/config.h"
+#include "mm/mem.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Number of buckets of slab lookup table
+ */
+#define NSLAB_HASH_SIZE                 32u
+
+/*-------------------------------------------------------  C++ extern base  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+struct nslab_page;
+
+/**@brief       Object cache structure
+ * @details     All elements of this structure are private members.
+ * @api
+ */
+struct nslab_cache
+{
+    const char *                name;
+    struct nslab *              slab;       /**<@brief Owner              */
+    struct nslab_cache *        next;       /**<@brief Next bigger cache  */
+    struct nslab_page *         partial;    /**<@brief Slabs with free obj*/
+    size_t                      size;       /**<@brief Object stride      */
+    uint32_t                    per_slab;   /**<@brief Objects in a slab  */
+    uint32_t                    colors;     /**<@brief Number of colors   */
+    uint32_t                    color;      /**<@brief Next slab color    */
+    uint32_t                    n_slabs;
+};
+
+/**@brief       Object cache type
+ * @api
+ */
+typedef struct nslab_cache nslab_cache;
+
+/**@brief       Slab memory object structure
+ * @details     All elements of this structure are private members.
+ * @api
+ */
+struct nslab
+{
+    struct nmem                 mem_class;
+    struct nmem *               backing;
+    struct nslab_cache *        caches;     /**<@brief Sorted by size     */
+    struct nslab_page *         hash[NSLAB_HASH_SIZE];
+};
+
+/**@brief       Slab memory object type
+ * @api
+ */
+typedef struct nslab nslab;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+/**@brief       Initialize slab memory object
+ * @param       slab
+ *              Pointer to slab memory object
+ * @param       backing
+ *              Memory object which provides slabs
+ * @api
+ */
+void nslab_init(struct nslab * slab, struct nmem * backing);
+
+
+
+/**@brief       Initialize an object cache
+ * @param       slab
+ *              Pointer to slab memory object
+ * @param       cache
+ *              Pointer to cache structure
+ * @param       name
+ *              Name of the cache, used only for debugging
+ * @param       size
+ *              Size of objects in bytes
+ * @api
+ */
+void nslab_cache_init(struct nslab * slab, struct nslab_cache * cache,
+        const char * name, size_t size);
+
+
+
+/**@brief       Allocate an object from a cache
+ * @return      Pointer to object
+ *  @retval     NULL - backing memory is exhausted
+ * @iclass
+ */
+void * nslab_cache_alloc_i(struct nslab_cache * cache);
+
+
+
+/**@brief       Allocate an object from a cache
+ * @details     See @ref nslab_cache_alloc_i.
+ * @api
+ */
+void * nslab_cache_alloc(struct nslab_cache * cache);
+
+
+
+/**@brief       Return an object to its cache
+ * @iclass
+ */
+void nslab_cache_free_i(struct nslab_cache * cache, void * mem);
+
+
+
+/**@brief       Return an object to its cache
+ * @api
+ */
+void nslab_cache_free(struct nslab_cache * cache, void * mem);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of slab.h
+ ******************************************************************************/
+#endif /* NEON_MM_SLAB_H_ */
@@ -0,0 +1,92 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Two-level segregated fit memory management
+ * @defgroup    mm_tlsf Two-level segregated fit memory management
+ * @brief       Two-level segregated fit memory management
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     mm_tlsf
+@section        tlsf_bins Free block bins
+
+The TLSF allocator keeps free blocks in bins. The first level bin is selected
+by the most significant bit of block size and each first level range is split
+into 16 second level bins. A bitmap of non-empty bins on each level finds a
+block which is big enough with two bit scans, so both allocation and free
+execute in constant time regardless of the number of free blocks.
+
+A request is rounded up to the next bin boundary, so the allocator never
+walks a bin, and the waste of a request is bounded to 1/16 of its size.
+Neighbouring free blocks are merged immediately.
+
+The control structure of the allocator is placed at the beginning of the
+storage, its size depends on @ref CONFIG_TLSF_MAX_SIZE_BITS.
+*/
+
+#ifndef NEON_MM_TLSF_H_
+#define NEON_MM_TLSF_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+
+#include "mm/mem.h"
+#include "base/debug.h"
+#include "base/bitop.h"
+
+/*===============================================================  MACRO's  ==*/
+
+#define NTLSF_BUNDLE_STRUCT(name, size)                                     \
+    NMEM_BUNDLE_STRUCT(name, size)
+
+#define NTLSF_BUNDLE_STRUCT_INIT(instance)                                  \
+    NMEM_BUNDLE_STRUCT_INIT(instance, 1, tlsf_init_alloc, NSIGNATURE_TLSF)
+
+#define NTLSF_BUNDLE_DEFINE(name, size)                                     \
+    NTLSF_BUNDLE_STRUCT(name, size) name =                                  \
+        NTLSF_BUNDLE_STRUCT_INIT(name)
+
+#define NTLSF_FROM_BUNDLE(instance)     NMEM_FROM_BUNDLE(instance)
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+void * tlsf_init_alloc(struct nmem * tlsf_obj, size_t size);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of tlsf.h
+ ******************************************************************************/
+#endif /* NEON_MM_TLSF_H_ */
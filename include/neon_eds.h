@@ -64,23 +64,41 @@
 
 /* EDS Timer */
 #include "timer/timer.h"
+#if (CONFIG_HRTIMER == 1)
+#include "timer/hrtimer.h"
+#endif
 
 /* EDS Memory Management */
+#include "mm/arena.h"
+#include "mm/epool.h"
 #include "mm/heap.h"
+#if (CONFIG_HUGEMEM == 1)
+#include "mm/hugemem.h"
+#endif
+#include "mm/lfpool.h"
 #include "mm/mem.h"
 #include "mm/pool.h"
+#include "mm/slab.h"
 #include "mm/static.h"
 #include "mm/stdheap.h"
+#include "mm/tlsf.h"
 
 /* EDS Scheduler */
 #include "sched/sched.h"
 #include "sched/deferred.h"
 
 /* EDS Event Procesing */
+#if (CONFIG_EBUS == 1)
+#include "ep/ebus.h"
+#endif
 #include "ep/epa.h"
 #include "ep/etimer.h"
+#if (CONFIG_ETRACE == 1)
+#include "ep/etrace.h"
+#endif
 #include "ep/event.h"
 #include "ep/smp.h"
+#include "ep/smarray.h"
 
 /*===============================================================  MACRO's  ==*/
 
@@ -31,8 +31,10 @@
 
 /*=========================================================  INCLUDE FILES  ==*/
 
+#include <stdint.h>
+
 #include "base/config.h"
-#include "base/dlist.h"
+#include "base/debug.h"
 
 /*===============================================================  MACRO's  ==*/
 /*-------------------------------------------------------  C++ extern base  --*/
@@ -44,13 +46,16 @@ extern "C" {
 
 /**
  * @brief       Deferred job structure
+ * @details     All elements of this structure are private members.
  * @api
  */
 struct nsched_deferred
 {
-	struct ndlist 				list;                  /* Linked list of jobs */               
+	struct nsched_deferred *	next;                /* Next pending job */
 	void 					 (* fn)(void * arg);   /* Associated job function */
 	void *						arg;                     /* Function argument */
+	uint8_t						priority;                 /* Priority level */
+	uint8_t						is_pending;          /* Job is submitted */
 	NSIGNATURE_DECLARE							  /* This structure signature */
 };
 
@@ -74,10 +79,28 @@ struct nsched_deferred
 void nsched_deferred_init(struct nsched_deferred * deferred, 
         void (* fn)(void *), void * arg);
 
+/**
+ * @brief       Set priority level of a deferred job
+ * @details     Pending jobs of higher priority level are executed before jobs
+ *              of lower priority level. Jobs of the same level are executed in
+ *              submission order. Initialized job has priority level 0.
+ * @param       deferred
+ *              Pointer to initialized deferred job structure which is not
+ *              pending.
+ * @param       priority
+ *              Priority level, less than @ref CONFIG_DEFERRED_PRIORITIES.
+ * @api
+ */
+void nsched_deferred_set_priority(struct nsched_deferred * deferred,
+        uint8_t priority);
+
 /**
  * @brief       Activate a deferred job function.
  * @details     This function will activate the associated deferred job 
- *              function as soon as possible.
+ *              function as soon as possible. It does not take the core lock,
+ *              so it may be called from any thread or interrupt. A job which
+ *              is already pending is executed only once. The job may activate
+ *              itself again from the job function.
  * @param       deferred
  *              Pointer to allocated deferred job function.
  * @api
@@ -145,6 +145,10 @@ struct nthread * nthread_get_current(void);
 
 
 
+uint_fast8_t nthread_get_current_priority(void);
+
+
+
 void ntask_init(struct ntask * task, const char * name, uint8_t priority, 
         void (* vf_task)(struct ntask *, void *), void * arg);
 
@@ -0,0 +1,250 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       High resolution timer header
+ * @defgroup    timer_hrtimer High resolution timer
+ * @brief       High resolution timer
+ *********************************************************************//** @{ */
+
+/**
+@addtogroup     timer_hrtimer
+@section        hrtimer_deadline Deadlines
+
+High resolution timers do not depend on the core timer tick. Each timer expires
+at an absolute deadline given in nanoseconds of CLOCK_MONOTONIC, and a service
+thread sleeps until the earliest deadline. Periodic timers are re-armed at
+previous deadline plus period, so a late callback does not shift the following
+deadlines. When a callback is late for more than a whole period the missed
+expirations are skipped and counted, see @ref nhrtimer_overrun.
+
+A timer may be given slack, so it expires anywhere between its deadline and
+deadline plus slack. The service thread sleeps until the earliest deadline plus
+slack and then runs all timers whose deadline has passed, so soft timeouts
+with overlapping slack cost a single wakeup.
+
+Timer callbacks are called with the core lock held, the same as callbacks of
+core timers, so they may use the I-class functions.
+
+The service thread is created when the first timer is started and it runs until
+@ref nhrtimer_stop is called.
+*/
+
+#ifndef NEON_TIMER_HRTIMER_H_
+#define NEON_TIMER_HRTIMER_H_
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "base/config.h"
+#include "base/debug.h"
+#include "base/error.h"
+
+/*===============================================================  MACRO's  ==*/
+
+/**@brief       Validate the pointer to high resolution timer object
+ * @note        This macro may be used only when @ref CONFIG_API_VALIDATION
+ *              macro is enabled.
+ * @api
+ */
+#if (CONFIG_API_VALIDATION == 1) || defined(__DOXYGEN__)
+#define N_IS_HRTIMER_OBJECT(timer_obj)                                          \
+    (NSIGNATURE_OF(timer_obj) == NSIGNATURE_HRTIMER)
+#else
+#define N_IS_HRTIMER_OBJECT(timer_obj)  (timer_obj)
+#endif
+
+/**@brief       Convert time (given in seconds) into nanoseconds
+ * @api
+ */
+#define NHRTIMER_SEC(time_sec)          ((uint64_t)(time_sec) * 1000000000ull)
+
+/**@brief       Convert time (given in milliseconds) into nanoseconds
+ * @api
+ */
+#define NHRTIMER_MS(time_ms)            ((uint64_t)(time_ms) * 1000000ull)
+
+/**@brief       Convert time (given in microseconds) into nanoseconds
+ * @api
+ */
+#define NHRTIMER_US(time_us)            ((uint64_t)(time_us) * 1000ull)
+
+/*------------------------------------------------------  C++ extern begin  --*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================  DATA TYPES  ==*/
+
+/**@brief       High resolution timer structure
+ * @details     All elements of this structure are private members. This
+ *              implementation detail is only exposed so the structure can be
+ *              allocated on stack.
+ * @api
+ */
+struct nhrtimer
+{
+    NSIGNATURE_DECLARE                              /**<@brief Debug signature*/
+    uint64_t                    deadline;           /**<@brief Expire time, ns*/
+    uint64_t                    slack;              /**<@brief Allowed delay  */
+    uint64_t                    period;             /**<@brief Period, ns     */
+    void                     (* fn)(void *);        /**<@brief Callback       */
+    void *                      arg;                /**<@brief Argument       */
+    uint32_t                    index;              /**<@brief Heap index + 1 */
+    uint32_t                    overrun;            /**<@brief Missed periods */
+};
+
+/**@brief       High resolution timer type
+ * @api
+ */
+typedef struct nhrtimer nhrtimer;
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*===================================================  FUNCTION PROTOTYPES  ==*/
+
+
+/**@brief       Initialize the high resolution timer structure
+ * @param       timer
+ *              Pointer to timer structure
+ * @api
+ */
+void nhrtimer_init(struct nhrtimer * timer);
+
+
+
+/**@brief       Returns current time of CLOCK_MONOTONIC in nanoseconds
+ * @api
+ */
+uint64_t nhrtimer_now(void);
+
+
+
+/**@brief       Start a timer
+ * @param       timer
+ *              Pointer to timer structure
+ * @param       deadline
+ *              Absolute expire time in nanoseconds, see @ref nhrtimer_now. A
+ *              deadline in the past expires immediately.
+ * @param       slack
+ *              Nanoseconds the timer may be delayed by so it expires together
+ *              with other timers. Use 0 for exact deadlines.
+ * @param       period
+ *              Period in nanoseconds, or 0 for one shot timer
+ * @param       fn
+ *              Pointer to callback function
+ * @param       arg
+ *              Argument for callback function
+ * @return      Operation status
+ *  @retval     NERROR_NONE - timer is started
+ *  @retval     NERROR_NO_RESOURCE - @ref CONFIG_HRTIMER_MAX timers are
+ *              already running or the service thread could not be created
+ * @iclass
+ */
+nerror nhrtimer_start_i(struct nhrtimer * timer, uint64_t deadline,
+        uint64_t slack, uint64_t period, void (* fn)(void *), void * arg);
+
+
+
+/**@brief       Start a timer
+ * @details     See @ref nhrtimer_start_i.
+ * @api
+ */
+nerror nhrtimer_start(struct nhrtimer * timer, uint64_t deadline,
+        uint64_t slack, uint64_t period, void (* fn)(void *), void * arg);
+
+
+
+/**@brief       Terminate a timer
+ * @param       timer
+ *              Pointer to timer structure
+ * @iclass
+ */
+void nhrtimer_cancel_i(struct nhrtimer * timer);
+
+
+
+/**@brief       Terminate a timer
+ * @param       timer
+ *              Pointer to timer structure
+ * @api
+ */
+void nhrtimer_cancel(struct nhrtimer * timer);
+
+
+
+/**@brief       Is a timer still running?
+ * @iclass
+ */
+bool nhrtimer_is_running_i(const struct nhrtimer * timer);
+
+
+
+/**@brief       Returns the number of nanoseconds before the timer fires up
+ * @return      Return the remaining time. If the timer is not running or the
+ *              deadline has passed the return value is 0.
+ * @api
+ */
+uint64_t nhrtimer_remaining(const struct nhrtimer * timer);
+
+
+
+/**@brief       Returns the number of skipped periods since timer was started
+ * @api
+ */
+uint32_t nhrtimer_overrun(const struct nhrtimer * timer);
+
+
+
+/**@brief       Returns the number of wakeups saved by timer slack
+ * @details     Counts expirations of timers with non-zero slack which were
+ *              executed in a wakeup of another timer.
+ * @api
+ */
+uint32_t nhrtimer_saved_wakeups(void);
+
+
+
+/**@brief       Stop the service thread
+ * @details     All running timers are cancelled and the function returns after
+ *              the service thread has exited. Starting a timer again creates a
+ *              new service thread.
+ * @note        The function waits for the service thread which needs the
+ *              core lock to exit. It must not be called from a timer callback
+ *              or while the calling thread holds the core lock, even if the
+ *              lock was entered more than once. Both are checked by the
+ *              contract.
+ * @api
+ */
+void nhrtimer_stop(void);
+
+/*--------------------------------------------------------  C++ extern end  --*/
+#ifdef __cplusplus
+}
+#endif
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//******************************************************
+ * END of hrtimer.h
+ ******************************************************************************/
+#endif /* NEON_TIMER_HRTIMER_H_ */
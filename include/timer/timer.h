@@ -92,6 +92,8 @@
 /**@brief       Timer attribute: repeat
  * @details     When this attribute is specified then the timer will
  *              fire up until it is explicitly stopped with ntimer_cancel().
+ *              Each next expiry is counted from the previous expiry tick, so
+ *              the period does not drift when callbacks are late.
  * @api
  */
 #define NTIMER_ATTR_REPEAT              (0x1u << 1)
@@ -112,6 +114,7 @@
 		NDLIST_INITIALIZER((name).list),									    \
 		0,																		\
 		0,																		\
+		0,																		\
 		NULL,																	\
 		NULL																	\
 	}
@@ -136,8 +139,9 @@ struct ntimer
 {
 	NSIGNATURE_DECLARE								/**<@brief Debug signature*/
     struct ndlist               list;               /**<@brief Linked list    */
-    uint32_t                    rtick;              /**<@brief Relative ticks */
+    uint32_t                    expires;            /**<@brief Expire tick    */
     uint32_t                    itick;              /**<@brief Initial ticks  */
+    uint32_t                    slack;              /**<@brief Allowed delay  */
     void                     (* fn)(void *);        /**<@brief Callback       */
     void *                      arg;                /**<@brief Argument       */
 };
@@ -175,6 +179,9 @@ void ntimer_init(struct ntimer * timer);
  *              Pointer to timer structure
  * @param       tick
  *              Number of ticks to run
+ * @param       slack
+ *              Number of ticks the timer may be delayed by so it expires
+ *              together with other timers. Use 0 for exact timeouts.
  * @param       fn
  *              Pointer to callback function
  * @param       arg
@@ -182,8 +189,8 @@ void ntimer_init(struct ntimer * timer);
  * @iclass
  * @api
  */
-void ntimer_start_i(struct ntimer * timer, uint32_t tick, void (* fn)(void *),
-		void * arg, uint8_t flags);
+void ntimer_start_i(struct ntimer * timer, uint32_t tick, uint32_t slack,
+        void (* fn)(void *), void * arg, uint8_t flags);
 
 
 
@@ -192,14 +199,17 @@ void ntimer_start_i(struct ntimer * timer, uint32_t tick, void (* fn)(void *),
  *              Pointer to timer structure
  * @param       tick
  *              Number of ticks to run
+ * @param       slack
+ *              Number of ticks the timer may be delayed by so it expires
+ *              together with other timers. Use 0 for exact timeouts.
  * @param       fn
  *              Pointer to callback function
  * @param       arg
  *              Argument for callback function
  * @api
  */
-void ntimer_start(struct ntimer * timer, uint32_t tick, void (* fn)(void *),
-		void * arg, uint8_t flags);
+void ntimer_start(struct ntimer * timer, uint32_t tick, uint32_t slack,
+        void (* fn)(void *), void * arg, uint8_t flags);
 
 
 
@@ -242,6 +252,42 @@ bool ntimer_is_running_i(const struct ntimer * timer);
  */
 uint32_t ntimer_remaining(const struct ntimer * timer);
 
+
+
+/**@brief       Returns the number of core timer ticks since the start
+ * @details     The counter wraps around, use wrap-around safe arithmetic when
+ *              comparing two tick values.
+ * @api
+ */
+uint32_t ntimer_get_tick(void);
+
+
+
+/**@brief       Returns the number of wakeups saved by timer slack
+ * @details     Counts expirations of timers with non-zero slack which were
+ *              delayed onto a tick where another timer has already expired.
+ *              With a tickless core timer each of them is a wakeup which did
+ *              not happen.
+ * @api
+ */
+uint32_t ntimer_saved_wakeups(void);
+
+
+
+#if (CONFIG_TIMER_BATCH == 1) || defined(__DOXYGEN__)
+/**@brief       Run callbacks of timers expired by the core timer
+ * @details     The core timer only moves expired timers to a batch. This
+ *              function runs their callbacks and re-arms the periodic timers.
+ *              Each callback is called with the lock held, but the lock is
+ *              released between callbacks.
+ * @note        This function must be called by the port after
+ *              ncore_timer_isr(), without holding the lock.
+ * @note        To use this API call the configuration option
+ *              @ref CONFIG_TIMER_BATCH must be enabled.
+ */
+void ntimer_run_expired(void);
+#endif
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
@@ -73,6 +73,10 @@
 
 #define ncore_os_exit()
 
+#define ncore_os_set_dispatcher()
+
+#define ncore_os_is_dispatcher()            true
+
 /*-------------------------------------------------------  C++ extern base  --*/
 #ifdef __cplusplus
 extern "C" {
@@ -73,6 +73,13 @@
 
 #define ncore_os_exit()
 
+#define ncore_os_set_dispatcher()
+
+/**@brief       The scheduler is dispatched outside of exception handlers
+ */
+#define ncore_os_is_dispatcher()                                                \
+    ((*((uint32_t volatile *)0xe000ed04u) & 0x1ffu) == 0u)
+
 /*-------------------------------------------------------  C++ extern base  --*/
 #ifdef __cplusplus
 extern "C" {
@@ -74,6 +74,14 @@
  */
 #define PORT_C_ALIGN(align)                 __attribute__((aligned (align)))
 
+/**@brief       Declare a variable which has a separate instance in each thread
+ */
+#define PORT_C_THREAD_LOCAL                 __thread
+
+/**@brief       Provides the return address of current function
+ */
+#define PORT_C_RETURN_ADDRESS()             __builtin_return_address(0)
+
 /**@brief       Cast a member of a structure out to the containing structure
  * @param       ptr
  *              the pointer to the member.
@@ -110,6 +110,9 @@ struct PORT_C_ALIGN(NCPU_DATA_ALIGNMENT) ncore_atomic
 extern pthread_mutex_t          g_idle_lock;
 extern pthread_mutex_t          g_global_lock;
 extern bool                     g_should_exit;
+extern pthread_t                g_dispatcher;
+extern PORT_C_THREAD_LOCAL uint32_t g_lock_depth;
+extern bool                     g_has_dispatcher;
 
 /*===================================================  FUNCTION PROTOTYPES  ==*/
 
@@ -183,6 +186,24 @@ void ncore_ref_decrement(
 
 
 
+/**@brief       Prepare the deferred work executor thread
+ */
+void ncore_deferred_init(void);
+
+
+
+/**@brief       Wake up the deferred work executor thread
+ */
+void ncore_deferred_do(void);
+
+
+
+/**@brief       Execute pending deferred jobs, called by the executor thread
+ */
+extern void ncore_deferred_work(void);
+
+
+
 PORT_C_INLINE
 void ncore_os_ready(void * thread)
 {
@@ -201,6 +222,32 @@ void ncore_os_block(void * thread)
 
 
 
+/**@brief       Remember the thread which runs the scheduler
+ * @note        Called with the core lock held.
+ */
+PORT_C_INLINE
+void ncore_os_set_dispatcher(void)
+{
+    g_dispatcher     = pthread_self();
+    g_has_dispatcher = true;
+}
+
+
+
+/**@brief       Is the caller the thread which runs the scheduler?
+ * @details     Timer, deferred and event bus threads run concurrently with
+ *              the scheduler thread, so they are not the dispatcher even while
+ *              a thread is being dispatched.
+ * @note        Called with the core lock held.
+ */
+PORT_C_INLINE
+bool ncore_os_is_dispatcher(void)
+{
+    return (g_has_dispatcher && pthread_equal(pthread_self(), g_dispatcher));
+}
+
+
+
 PORT_C_INLINE
 void ncore_lock_enter(
     struct ncore_lock *          lock)
@@ -208,6 +255,7 @@ void ncore_lock_enter(
     (void)lock;
 
     pthread_mutex_lock(&g_global_lock);
+    g_lock_depth++;
 }
 
 
@@ -218,9 +266,24 @@ void ncore_lock_exit(
 {
     (void)lock;
 
+    g_lock_depth--;
     pthread_mutex_unlock(&g_global_lock);
 }
 
+
+
+/**@brief       Returns how many times the calling thread has entered the core
+ *              lock
+ * @details     The core lock is recursive, functions which must wait for
+ *              another thread to take the lock use this to check that the
+ *              caller does not hold it.
+ */
+PORT_C_INLINE
+uint32_t ncore_lock_depth(void)
+{
+    return (g_lock_depth);
+}
+
 /*--------------------------------------------------------  C++ extern end  --*/
 #ifdef __cplusplus
 }
@@ -34,9 +34,12 @@
 #include <stdio.h>
 #include <signal.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/time.h>
+#include <sys/eventfd.h>
 
 #include "port/core.h"
+#include "timer/timer.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
 /*======================================================  LOCAL DATA TYPES  ==*/
@@ -65,17 +68,26 @@ static void timer_init(void);
 
 static void timer_term(void);
 
+
+
+static void * deferred_thread(void * arg);
+
 /*=======================================================  LOCAL VARIABLES  ==*/
 
 static struct sigaction         g_sigaction;
 static pthread_t                g_timer_thread;
 static pthread_mutex_t          g_timer_lock;
+static pthread_t                g_deferred_thread;
+static int                      g_deferred_fd = -1;
 
 /*======================================================  GLOBAL VARIABLES  ==*/
 
 pthread_mutex_t                 g_idle_lock;
 pthread_mutex_t                 g_global_lock;
 bool                            g_should_exit = false;
+pthread_t                       g_dispatcher;
+bool                            g_has_dispatcher = false;
+PORT_C_THREAD_LOCAL uint32_t    g_lock_depth;
 
 const uint_fast8_t              g_log2_lookup[256] =
 {
@@ -141,6 +153,9 @@ static void * timer_thread(void * arg)
         ncore_lock_enter(NULL);
         ncore_timer_isr();
         ncore_lock_exit(NULL);
+#if (CONFIG_TIMER_BATCH == 1)
+        ntimer_run_expired();
+#endif
     }
 
     return NULL;
@@ -174,6 +189,28 @@ static void timer_term(void)
     ncore_timer_disable();
 }
 
+
+
+/**@brief       Deferred work executor thread
+ * @details     The thread blocks on the eventfd and executes all pending
+ *              jobs when it is signalled. The counter of eventfd coalesces
+ *              all wakeups which arrive while the jobs are executing.
+ */
+static void * deferred_thread(void * arg)
+{
+    (void)arg;
+
+    for (;;) {
+        uint64_t                count;
+
+        if (read(g_deferred_fd, &count, sizeof(count)) == sizeof(count)) {
+            ncore_deferred_work();
+        }
+    }
+
+    return NULL;
+}
+
 /*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
 /*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
 
@@ -251,12 +288,28 @@ void ncore_timer_disable(void)
 
 void ncore_deferred_init(void)
 {
+    g_deferred_fd = eventfd(0, EFD_CLOEXEC);
+
+    if (g_deferred_fd == -1) {
+        perror("error calling eventfd()");
+        exit(1);
+    }
+    pthread_create(&g_deferred_thread, NULL, deferred_thread, NULL);
 }
 
 
 
 void ncore_deferred_do(void)
 {
+    uint64_t                    one = 1u;
+
+    /* NOTE:
+     * Write to eventfd is async-signal-safe and does not block unless the
+     * counter overflows, so jobs may be submitted from any thread.
+     */
+    if (write(g_deferred_fd, &one, sizeof(one)) != sizeof(one)) {
+        perror("error calling write() on deferred eventfd");
+    }
 }
 
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
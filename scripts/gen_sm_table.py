@@ -0,0 +1,404 @@
+#!/usr/bin/env python3
+
+#
+# This file is part of Neon.
+#
+# Copyright (C) 2010 - 2017 Nenad Radulovic
+#
+# Neon is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Neon is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# This script generates table driven state machine from a textual model. The
+# generated tables are dispatched by ``n_sm_table_dispatch()`` when
+# CONFIG_SMP_TABLE is enabled.
+#
+# Usage: gen_sm_table.py MODEL OUTPUT_BASE
+#
+# The script writes OUTPUT_BASE.h and OUTPUT_BASE.c files.
+#
+# Model syntax, nesting of states is defined by indentation:
+#
+#   machine blinky              # name of generated table: blinky_table
+#   event_base NEVENT_USER_ID   # id of the first event, optional
+#   event TICK                  # events get consecutive ids
+#   event STOP
+#   initial off                 # initial top level state
+#
+#   state off
+#       entry led_off           # entry action, optional
+#       exit stop_timer         # exit action, optional
+#       on TICK -> on / count   # transition with an action
+#   state on
+#       init slow               # initial sub-state of a composite state
+#       on STOP -> off
+#       on TICK [is_last] -> off
+#       state slow
+#           on TICK -> fast
+#       state fast
+#           on STOP / log_stop  # internal transition, no state change
+#
+# A transition is written as: on EVENT [[guard]] [-> TARGET] [/ action]
+#
+# When a state does not handle an event, or all its guards fail, the event is
+# offered to the enclosing states. The action is executed before the exit
+# actions. Transition paths follow the same rules as the HSM dispatcher:
+# transition to self exits and enters the state again, transition to the
+# direct super state only exits the source state.
+
+import re
+import sys
+
+NONE = 'NSM_TABLE_NONE'
+
+TRANSITION = re.compile(
+    r'^on\s+(?P<event>\w+)'
+    r'(\s*\[\s*(?P<guard>\w+)\s*\])?'
+    r'(\s*->\s*(?P<target>\w+))?'
+    r'(\s*/\s*(?P<action>\w+))?\s*$')
+
+
+class ModelError(Exception):
+    pass
+
+
+class State:
+    def __init__(self, name, parent, line):
+        self.name = name
+        self.parent = parent
+        self.line = line
+        self.index = None
+        self.init = None
+        self.entry = None
+        self.exit = None
+        self.transitions = []
+
+    def ancestors(self):
+        state = self
+        while state is not None:
+            yield state
+            state = state.parent
+
+
+class Transition:
+    def __init__(self, source, event, guard, target, action, line):
+        self.source = source
+        self.event = event
+        self.guard = guard
+        self.target = target
+        self.action = action
+        self.line = line
+        self.index = None
+        self.lca = None
+        self.next = None
+
+
+class Machine:
+    def __init__(self):
+        self.name = None
+        self.event_base = 'NEVENT_USER_ID'
+        self.events = []
+        self.initial = None
+        self.states = []
+
+    def state(self, name, line):
+        for state in self.states:
+            if state.name == name:
+                return state
+        raise ModelError('line %d: unknown state %s' % (line, name))
+
+
+def parse(lines):
+    machine = Machine()
+    stack = []
+
+    for number, text in enumerate(lines, 1):
+        text = text.split('#', 1)[0].rstrip()
+
+        if not text.strip():
+            continue
+        indent = len(text) - len(text.lstrip())
+        words = text.split()
+        keyword = words[0]
+
+        while stack and stack[-1][0] >= indent:
+            stack.pop()
+        owner = stack[-1][1] if stack else None
+
+        if keyword == 'state' and len(words) == 2:
+            state = State(words[1], owner, number)
+            machine.states.append(state)
+            stack.append((indent, state))
+        elif owner is None:
+            if keyword == 'machine' and len(words) == 2:
+                machine.name = words[1]
+            elif keyword == 'event_base' and len(words) == 2:
+                machine.event_base = words[1]
+            elif keyword == 'event' and len(words) == 2:
+                machine.events.append(words[1])
+            elif keyword == 'initial' and len(words) == 2:
+                machine.initial = (words[1], number)
+            else:
+                raise ModelError('line %d: syntax error' % number)
+        elif keyword in ('init', 'entry', 'exit') and len(words) == 2:
+            setattr(owner, keyword, (words[1], number) if keyword == 'init'
+                    else words[1])
+        elif keyword == 'on':
+            match = TRANSITION.match(text.strip())
+
+            if not match:
+                raise ModelError('line %d: invalid transition' % number)
+            owner.transitions.append(Transition(owner, match.group('event'),
+                match.group('guard'), match.group('target'),
+                match.group('action'), number))
+        else:
+            raise ModelError('line %d: syntax error' % number)
+
+    return machine
+
+
+def lca(source, target):
+    if source is target:
+        return source.parent
+    if source.parent is target:
+        return target
+    source_ancestors = list(source.ancestors())
+
+    for state in target.ancestors():
+        if state in source_ancestors:
+            return state.parent if state is target else state
+    return None
+
+
+def resolve(machine):
+    if machine.name is None:
+        raise ModelError('machine name is not defined')
+    if not machine.states:
+        raise ModelError('no states are defined')
+    if not machine.events:
+        raise ModelError('no events are defined')
+    if machine.initial is None:
+        raise ModelError('initial state is not defined')
+    names = set()
+
+    for index, state in enumerate(machine.states):
+        if state.name in names:
+            raise ModelError('line %d: duplicate state %s' %
+                             (state.line, state.name))
+        names.add(state.name)
+        state.index = index
+    machine.initial = machine.state(*machine.initial)
+
+    if machine.initial.parent is not None:
+        raise ModelError('initial state %s is not a top level state' %
+                         machine.initial.name)
+    transitions = []
+
+    for state in machine.states:
+        if state.init is not None:
+            init = machine.state(*state.init)
+
+            if init is state or state not in init.ancestors():
+                raise ModelError('line %d: %s is not a sub-state of %s' %
+                                 (state.init[1], init.name, state.name))
+            state.init = init
+
+        for transition in state.transitions:
+            if transition.event not in machine.events:
+                raise ModelError('line %d: unknown event %s' %
+                                 (transition.line, transition.event))
+            if transition.target is not None:
+                transition.target = machine.state(transition.target,
+                                                  transition.line)
+                transition.lca = lca(state, transition.target)
+            transition.index = len(transitions)
+            transitions.append(transition)
+
+    def first(state, event):
+        for ancestor in state.ancestors():
+            for transition in ancestor.transitions:
+                if transition.event == event:
+                    return transition
+        return None
+
+    for state in machine.states:
+        for position, transition in enumerate(state.transitions):
+            if transition.guard is None:
+                continue
+            same = [t for t in state.transitions[position + 1:]
+                    if t.event == transition.event]
+            transition.next = same[0] if same else (
+                first(state.parent, transition.event) if state.parent else None)
+
+    map_ = [[first(state, event) for event in machine.events]
+            for state in machine.states]
+
+    return transitions, map_
+
+
+def index(item):
+    return NONE if item is None else str(item.index)
+
+
+def function(item):
+    return 'NULL' if item is None else '&' + item
+
+
+def generate_header(machine, base):
+    guard = 'NEON_SM_TABLE_%s_H_' % machine.name.upper()
+    actions = set()
+    guards = set()
+
+    for state in machine.states:
+        actions.update(a for a in (state.entry, state.exit) if a)
+
+        for transition in state.transitions:
+            if transition.action:
+                actions.add(transition.action)
+            if transition.guard:
+                guards.add(transition.guard)
+    out = []
+    out.append('/*')
+    out.append(' * This file is automatically generated by gen_sm_table.py script.')
+    out.append(' * Do not edit it manually since any change will be overwriten!')
+    out.append(' */')
+    out.append('')
+    out.append('#ifndef %s' % guard)
+    out.append('#define %s' % guard)
+    out.append('')
+    out.append('#include <stdbool.h>')
+    out.append('')
+    out.append('#include "ep/smp.h"')
+    out.append('#include "ep/event.h"')
+    out.append('')
+    out.append('#ifdef __cplusplus')
+    out.append('extern "C" {')
+    out.append('#endif')
+    out.append('')
+    out.append('enum %s_event' % machine.name)
+    out.append('{')
+
+    for position, event in enumerate(machine.events):
+        value = ' = %s' % machine.event_base if position == 0 else ''
+        out.append('    %s%s,' % (event, value))
+    out.append('};')
+    out.append('')
+    out.append('enum %s_state' % machine.name)
+    out.append('{')
+
+    for state in machine.states:
+        out.append('    %s_STATE_%s = %d,' % (machine.name.upper(),
+                                              state.name.upper(), state.index))
+    out.append('};')
+    out.append('')
+    out.append('extern const struct nsm_table %s_table;' % machine.name)
+    out.append('')
+
+    for action in sorted(actions):
+        out.append('void %s(struct nsm * sm, const struct nevent * event);' %
+                   action)
+
+    for name in sorted(guards):
+        out.append('bool %s(struct nsm * sm, const struct nevent * event);' %
+                   name)
+    out.append('')
+    out.append('#ifdef __cplusplus')
+    out.append('}')
+    out.append('#endif')
+    out.append('')
+    out.append('#endif /* %s */' % guard)
+
+    return '\n'.join(out) + '\n'
+
+
+def generate_source(machine, base, transitions, map_):
+    out = []
+    out.append('/*')
+    out.append(' * This file is automatically generated by gen_sm_table.py script.')
+    out.append(' * Do not edit it manually since any change will be overwriten!')
+    out.append(' */')
+    out.append('')
+    out.append('#include "%s.h"' % base.rsplit('/', 1)[-1])
+    out.append('')
+    out.append('static const struct nsm_table_state %s_states[] =' %
+               machine.name)
+    out.append('{')
+
+    for state in machine.states:
+        out.append('    {%s, %s, %s, %s},  /* %s */' % (
+            index(state.parent), index(state.init), function(state.entry),
+            function(state.exit), state.name))
+    out.append('};')
+    out.append('')
+
+    if transitions:
+        out.append('static const struct nsm_table_transition '
+                   '%s_transitions[] =' % machine.name)
+        out.append('{')
+
+        for transition in transitions:
+            out.append('    {%s, %s, %s, %s, %s},  /* %s: %s */' % (
+                function(transition.guard), function(transition.action),
+                index(transition.target), index(transition.lca),
+                index(transition.next), transition.source.name,
+                transition.event))
+        out.append('};')
+        out.append('')
+    out.append('static const uint16_t %s_map[] =' % machine.name)
+    out.append('{')
+
+    for state, row in zip(machine.states, map_):
+        out.append('    %s,  /* %s */' % (', '.join(index(t) for t in row),
+                                        state.name))
+    out.append('};')
+    out.append('')
+    out.append('const struct nsm_table %s_table =' % machine.name)
+    out.append('{')
+    out.append('    .state      = %s_states,' % machine.name)
+    out.append('    .transition = %s,' % ('%s_transitions' % machine.name
+                                          if transitions else 'NULL'))
+    out.append('    .map        = %s_map,' % machine.name)
+    out.append('    .n_states   = %du,' % len(machine.states))
+    out.append('    .n_events   = %du,' % len(machine.events))
+    out.append('    .event_base = %s,' % machine.event_base)
+    out.append('    .initial    = %du' % machine.initial.index)
+    out.append('};')
+
+    return '\n'.join(out) + '\n'
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('Usage: %s MODEL OUTPUT_BASE\n' % argv[0])
+        return 2
+    model, base = argv[1], argv[2]
+
+    try:
+        with open(model) as source:
+            machine = parse(source.readlines())
+        transitions, map_ = resolve(machine)
+    except ModelError as error:
+        sys.stderr.write('%s: %s\n' % (model, error))
+        return 1
+
+    with open(base + '.h', 'w') as header:
+        header.write(generate_header(machine, base))
+
+    with open(base + '.c', 'w') as source:
+        source.write(generate_source(machine, base, transitions, map_))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
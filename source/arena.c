@@ -0,0 +1,212 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Arena memory management implementation
+ * @addtogroup  mm_arena
+ *********************************************************************//** @{ */
+/**@defgroup    mm_arena_impl Implementation
+ * @brief       Arena memory management implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stdint.h>
+
+#include "port/core.h"
+#include "base/bitop.h"
+#include "mm/arena.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+/**@brief       Setup a bundle arena which was not used yet
+ */
+static void arena_setup(struct nmem * arena_obj);
+
+static void * arena_alloc(struct nmem * arena_obj, size_t size);
+
+static void arena_free(struct nmem * arena_obj, void * mem);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static void arena_setup(struct nmem * arena_obj)
+{
+    ncore_lock                  lock;
+
+    /* NOTE:
+     * Threads which do not use the core lock may race to the first
+     * allocation, so the arena is set up only once under the lock.
+     */
+    ncore_lock_enter(&lock);
+
+    if (arena_obj->vf_alloc == arena_init_alloc) {
+        uintptr_t               base = (uintptr_t)arena_obj->base;
+        size_t                  skew;
+
+        skew = NALIGN_UP(base, (uintptr_t)NCPU_DATA_ALIGNMENT) - base;
+
+        NREQUIRE(arena_obj->size > skew);
+
+        arena_obj->base    = (void *)(base + skew);
+        arena_obj->size    = NALIGN(arena_obj->size - skew,
+            (size_t)NCPU_DATA_ALIGNMENT);
+        arena_obj->free    = arena_obj->size;
+        arena_obj->vf_free = arena_free;
+#if defined(__GNUC__)
+        __atomic_store_n(&arena_obj->vf_alloc, arena_alloc, __ATOMIC_RELEASE);
+#else
+        arena_obj->vf_alloc = arena_alloc;
+#endif
+    }
+    ncore_lock_exit(&lock);
+}
+
+
+
+static void * arena_alloc(struct nmem * arena_obj, size_t size)
+{
+    size_t                      free;
+
+    NREQUIRE(NSIGNATURE_OF(arena_obj) == NSIGNATURE_ARENA);
+    NREQUIRE(size != 0u);
+
+    size = NALIGN_UP(size, (size_t)NCPU_DATA_ALIGNMENT);
+
+#if defined(__GNUC__)
+    free = __atomic_load_n(&arena_obj->free, __ATOMIC_RELAXED);
+
+    do {
+        if (size > free) {
+
+            return (NULL);
+        }
+    } while (!__atomic_compare_exchange_n(&arena_obj->free, &free,
+                free - size, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+#else
+    {
+        ncore_lock              lock;
+
+        ncore_lock_enter(&lock);
+        free = arena_obj->free;
+
+        if (size <= free) {
+            arena_obj->free = free - size;
+        }
+        ncore_lock_exit(&lock);
+
+        if (size > free) {
+
+            return (NULL);
+        }
+    }
+#endif
+
+    return ((void *)&((uint8_t *)arena_obj->base)[arena_obj->size - free]);
+}
+
+
+
+static void arena_free(struct nmem * arena_obj, void * mem)
+{
+    (void)arena_obj;
+    (void)mem;
+}
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+void * arena_init_alloc(struct nmem * arena_obj, size_t size)
+{
+    NREQUIRE(NSIGNATURE_OF(arena_obj) == NSIGNATURE_ARENA);
+    NREQUIRE(arena_obj->base);
+
+    arena_setup(arena_obj);
+
+    return (arena_alloc(arena_obj, size));
+}
+
+
+
+void narena_init(struct nmem * arena_obj, void * storage, size_t size)
+{
+    NREQUIRE(arena_obj);
+    NREQUIRE(NSIGNATURE_OF(arena_obj) != NSIGNATURE_ARENA);
+
+    n_mem_init(arena_obj, arena_init_alloc, storage, size, 1u);
+
+    NOBLIGATION(NSIGNATURE_IS(arena_obj, NSIGNATURE_ARENA));
+
+    arena_setup(arena_obj);
+}
+
+
+
+void * narena_alloc(struct nmem * arena_obj, size_t size)
+{
+    NREQUIRE(NSIGNATURE_OF(arena_obj) == NSIGNATURE_ARENA);
+
+    return (arena_obj->vf_alloc(arena_obj, size));
+}
+
+
+
+size_t narena_mark(struct nmem * arena_obj)
+{
+    NREQUIRE(NSIGNATURE_OF(arena_obj) == NSIGNATURE_ARENA);
+
+    if (arena_obj->vf_alloc == arena_init_alloc) {
+        arena_setup(arena_obj);
+    }
+
+    return (arena_obj->size - arena_obj->free);
+}
+
+
+
+void narena_release(struct nmem * arena_obj, size_t mark)
+{
+    NREQUIRE(NSIGNATURE_OF(arena_obj) == NSIGNATURE_ARENA);
+
+    if (arena_obj->vf_alloc == arena_init_alloc) {
+        arena_setup(arena_obj);
+    }
+    NREQUIRE(mark <= arena_obj->size - arena_obj->free);
+
+    arena_obj->free = arena_obj->size - mark;
+}
+
+
+
+void narena_reset(struct nmem * arena_obj)
+{
+    narena_release(arena_obj, 0u);
+}
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of arena.c
+ ******************************************************************************/
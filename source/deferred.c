@@ -30,24 +30,60 @@
 
 /*=========================================================  INCLUDE FILES  ==*/
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "sched/deferred.h"
 #include "base/debug.h"
 #include "port/core.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
+
+/* NOTE:
+ * Pending jobs are pushed without taking the core lock. Compilers which do
+ * not provide atomic builtins fall back to a short critical section.
+ */
+#if defined(__GNUC__)
+#define DEFERRED_CAS(ptr, expected, desired)                                    \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), true,            \
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+
+#define DEFERRED_EXCHANGE(ptr, value)                                           \
+    __atomic_exchange_n((ptr), (value), __ATOMIC_ACQ_REL)
+
+#define DEFERRED_LOAD(ptr)              __atomic_load_n((ptr), __ATOMIC_RELAXED)
+
+#define DEFERRED_STORE(ptr, value)                                              \
+    __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#endif
+
 /*======================================================  LOCAL DATA TYPES  ==*/
 
+/**@brief       Pending jobs
+ * @details     Each priority level is a LIFO stack of jobs. Producers only
+ *              push single jobs and the executor only takes a whole stack at
+ *              once, so the stack does not suffer from the ABA problem.
+ */
 struct sched_deferred_ctx
 {
-    struct ndlist               a;
-    struct ndlist               b;
-    struct ndlist *             pending;
-    struct ndlist *             working;
+    struct nsched_deferred *    pending[CONFIG_DEFERRED_PRIORITIES];
 };
 
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
 
-static struct nsched_deferred * ndlist_to_deferred(struct ndlist * list);
+/**@brief       Mark the job as pending
+ * @return      Returns false when the job was already pending.
+ */
+static bool deferred_mark(struct nsched_deferred * deferred);
+
+/**@brief       Push the job to pending stack
+ * @return      Returns true when the stack was empty.
+ */
+static bool deferred_push(struct nsched_deferred * deferred);
+
+/**@brief       Take all jobs of a priority level in submission order
+ */
+static struct nsched_deferred * deferred_take(uint_fast8_t priority);
 
 /*=======================================================  LOCAL VARIABLES  ==*/
 /*======================================================  GLOBAL VARIABLES  ==*/
@@ -57,9 +93,80 @@ static struct sched_deferred_ctx g_ctx;
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
 
 
-static struct nsched_deferred * ndlist_to_deferred(struct ndlist * list)
+static bool deferred_mark(struct nsched_deferred * deferred)
+{
+#if defined(__GNUC__)
+    return (DEFERRED_EXCHANGE(&deferred->is_pending, 1u) == 0u);
+#else
+    struct ncore_lock           lock;
+    bool                        is_idle;
+
+    ncore_lock_enter(&lock);
+    is_idle = deferred->is_pending == 0u;
+    deferred->is_pending = 1u;
+    ncore_lock_exit(&lock);
+
+    return (is_idle);
+#endif
+}
+
+
+
+static bool deferred_push(struct nsched_deferred * deferred)
 {
-    return (PORT_C_CONTAINER_OF(list, struct nsched_deferred, list));
+    struct nsched_deferred **   head = &g_ctx.pending[deferred->priority];
+
+#if defined(__GNUC__)
+    struct nsched_deferred *    next;
+
+    next = DEFERRED_LOAD(head);
+
+    do {
+        deferred->next = next;
+    } while (!DEFERRED_CAS(head, &next, deferred));
+
+    return (next == NULL);
+#else
+    struct ncore_lock           lock;
+
+    ncore_lock_enter(&lock);
+    deferred->next = *head;
+    *head          = deferred;
+    ncore_lock_exit(&lock);
+
+    return (deferred->next == NULL);
+#endif
+}
+
+
+
+static struct nsched_deferred * deferred_take(uint_fast8_t priority)
+{
+    struct nsched_deferred *    stack;
+    struct nsched_deferred *    batch;
+
+#if defined(__GNUC__)
+    stack = DEFERRED_EXCHANGE(&g_ctx.pending[priority], NULL);
+#else
+    struct ncore_lock           lock;
+
+    ncore_lock_enter(&lock);
+    stack = g_ctx.pending[priority];
+    g_ctx.pending[priority] = NULL;
+    ncore_lock_exit(&lock);
+#endif
+    batch = NULL;
+
+    /* Reverse the stack to get the submission order */
+    while (stack) {
+        struct nsched_deferred * deferred = stack;
+
+        stack          = deferred->next;
+        deferred->next = batch;
+        batch          = deferred;
+    }
+
+    return (batch);
 }
 
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
@@ -69,64 +176,103 @@ void nsched_deferred_init(struct nsched_deferred * deferred,
         void (* fn)(void *), void * arg)
 {
     static bool                 is_initialized;
+    ncore_lock                  lock;
 
     NREQUIRE(deferred);
     NREQUIRE(NSIGNATURE_OF(deferred) != NSIGNATURE_DEFER);
     NREQUIRE(fn);
 
+    /* NOTE:
+     * Deferred jobs may be initialized from several threads at once, the
+     * port must be initialized exactly once.
+     */
+    ncore_lock_enter(&lock);
+
     if (!is_initialized) {
         is_initialized = true;
 
         ncore_deferred_init();
-        g_ctx.pending = ndlist_init(&g_ctx.a);
-        g_ctx.working = ndlist_init(&g_ctx.b);
     }
-    deferred->fn = fn;
-    deferred->arg = arg;
-    ndlist_init(&deferred->list);
+    ncore_lock_exit(&lock);
+    deferred->next       = NULL;
+    deferred->fn         = fn;
+    deferred->arg        = arg;
+    deferred->priority   = 0u;
+    deferred->is_pending = 0u;
 
     NOBLIGATION(NSIGNATURE_IS(deferred, NSIGNATURE_DEFER));
 }
 
 
 
+void nsched_deferred_set_priority(struct nsched_deferred * deferred,
+        uint8_t priority)
+{
+    NREQUIRE(deferred);
+    NREQUIRE(NSIGNATURE_OF(deferred) == NSIGNATURE_DEFER);
+    NREQUIRE(deferred->is_pending == 0u);
+    NREQUIRE(priority < CONFIG_DEFERRED_PRIORITIES);
+
+    deferred->priority = priority;
+}
+
+
+
 void nsched_deferred_do(struct nsched_deferred * deferred)
 {
     NREQUIRE(deferred);
     NREQUIRE(NSIGNATURE_OF(deferred) == NSIGNATURE_DEFER);
 
-    if (ndlist_is_empty(&deferred->list)) {
-    	ndlist_add_after(g_ctx.pending, &deferred->list);
+    /* NOTE:
+     * The executor is woken up only by the job which makes a stack non-empty,
+     * later jobs are taken together with that one.
+     */
+    if (deferred_mark(deferred) && deferred_push(deferred)) {
+        ncore_deferred_do();
     }
-    ncore_deferred_do();
 }
 
 
 
 void ncore_deferred_work(void)
 {
-	struct ndlist *			tmp;
-    struct ndlist *         current;
+    uint_fast8_t                priority;
+
+    /* Execute all deferred functions, higher priority levels first. After
+     * each batch the scan starts again from the highest level, so jobs
+     * submitted by the batch are not delayed by lower priority work.
+     */
+    priority = CONFIG_DEFERRED_PRIORITIES;
+
+    while (priority != 0u) {
+        struct nsched_deferred * batch;
 
-    tmp			  = g_ctx.pending;
-    g_ctx.pending = g_ctx.working;
-    g_ctx.working = tmp;
+        batch = deferred_take(--priority);
 
-    /* Execute all deferred functions */
+        if (batch) {
+            priority = CONFIG_DEFERRED_PRIORITIES;
+        }
 
-    while (!ndlist_is_empty(g_ctx.working)) {
-    	struct nsched_deferred * deferred;
+        while (batch) {
+            struct nsched_deferred * deferred = batch;
 
-    	current = ndlist_next(g_ctx.working);
+            NREQUIRE(NSIGNATURE_OF(deferred) == NSIGNATURE_DEFER);
+            batch = deferred->next;
 
-		deferred = ndlist_to_deferred(current);
-		NREQUIRE(NSIGNATURE_OF(deferred) == NSIGNATURE_DEFER);
-		deferred->fn(deferred->arg);
-		ndlist_remove(current);
+            /* Clear the flag before calling the function, so a job which is
+             * submitted again while it runs is not lost.
+             */
+#if defined(__GNUC__)
+            DEFERRED_STORE(&deferred->is_pending, 0u);
+#else
+            deferred->is_pending = 0u;
+#endif
+            deferred->fn(deferred->arg);
+        }
     }
 }
 
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 /** @endcond *//** @} *//** @} *//*********************************************
- * END of sched.c
+ * END of deferred.c
  ******************************************************************************/
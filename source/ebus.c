@@ -0,0 +1,453 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Shared memory event bus implementation
+ * @addtogroup  event_bus
+ *********************************************************************//** @{ */
+/**@defgroup    event_bus_impl Implementation
+ * @brief       Shared memory event bus Implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#define _GNU_SOURCE
+
+#include "base/config.h"
+
+#if (CONFIG_EBUS == 1)
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "base/debug.h"
+#include "base/bitop.h"
+#include "ep/epa.h"
+#include "ep/event.h"
+#include "ep/ebus.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+/**@brief       Size of cache line, used to separate producer and consumer data
+ */
+#define EBUS_CACHE_LINE                 64u
+
+/**@brief       Magic number which is written when the ring is initialized
+ */
+#define EBUS_MAGIC                      0x4e425553u
+
+#define EBUS_LOAD(ptr)                  __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+
+#define EBUS_STORE(ptr, val)            __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+
+#define EBUS_CAS(ptr, expected, desired)                                        \
+    __atomic_compare_exchange_n(ptr, expected, desired, true,                   \
+        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+
+#define EBUS_FENCE()                    __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/**@brief       Ring header which is placed at the beginning of shared memory
+ * @details     The ring does not contain any pointers. Slots are located by
+ *              their index, so each process can map the ring at a different
+ *              address.
+ */
+struct nebus_ring
+{
+    uint32_t                    magic;
+    uint32_t                    mask;   /**<@brief Number of slots - 1    */
+    uint32_t                    stride; /**<@brief Size of a slot         */
+    uint32_t                    waiting;/**<@brief Receiver futex word    */
+                                        /**<@brief Producers position     */
+    uint64_t PORT_C_ALIGN(EBUS_CACHE_LINE) head;
+                                        /**<@brief Consumer position      */
+    uint64_t PORT_C_ALIGN(EBUS_CACHE_LINE) tail;
+};
+
+/**@brief       Slot header, event data follows the header
+ */
+struct ebus_slot
+{
+    uint64_t                    seq;    /**<@brief Slot sequence          */
+    uint16_t                    epa_id; /**<@brief Destination identifier */
+    uint16_t                    id;     /**<@brief Event identifier       */
+    uint32_t                    size;   /**<@brief Size of event data     */
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static size_t ring_header_size(void);
+
+static struct ebus_slot * ring_slot(struct nebus_ring * ring, uint64_t pos);
+
+static void ring_wait(struct nebus_ring * ring);
+
+static void ring_wake(struct nebus_ring * ring);
+
+/**@brief       Receive one event from the ring
+ * @return      Returns false if the ring is empty
+ */
+static bool ebus_receive(struct nebus * bus);
+
+static void * ebus_thread(void * arg);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static size_t ring_header_size(void)
+{
+    return (NALIGN_UP(sizeof(struct nebus_ring), EBUS_CACHE_LINE));
+}
+
+
+
+static struct ebus_slot * ring_slot(struct nebus_ring * ring, uint64_t pos)
+{
+    return ((struct ebus_slot *)((uint8_t *)ring + ring_header_size() +
+        (size_t)(pos & ring->mask) * ring->stride));
+}
+
+
+
+static void ring_wait(struct nebus_ring * ring)
+{
+    syscall(SYS_futex, &ring->waiting, FUTEX_WAIT, 1, NULL, NULL, 0);
+}
+
+
+
+static void ring_wake(struct nebus_ring * ring)
+{
+    syscall(SYS_futex, &ring->waiting, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+
+
+static bool ebus_receive(struct nebus * bus)
+{
+    struct nebus_ring *         ring = bus->ring;
+    struct ebus_slot *          slot;
+    struct nepa *               epa;
+    uint64_t                    pos;
+
+    pos  = ring->tail;
+    slot = ring_slot(ring, pos);
+
+    if (EBUS_LOAD(&slot->seq) != (pos + 1u)) {
+
+        return (false);
+    }
+    epa = NULL;
+
+    if (slot->epa_id < CONFIG_EBUS_EPA_IDS) {
+        epa = bus->epa[slot->epa_id];
+    }
+
+    if (epa) {
+        struct nevent *         event;
+
+        event = nevent_create(sizeof(struct nevent) + slot->size, slot->id);
+
+        if (event) {
+            memcpy(event + 1, slot + 1, slot->size);
+            nepa_send_event(epa, event);
+        }
+    }
+    EBUS_STORE(&slot->seq, pos + ring->mask + 1u);
+    ring->tail = pos + 1u;
+
+    return (true);
+}
+
+
+
+static void * ebus_thread(void * arg)
+{
+    struct nebus *              bus = arg;
+
+    while (!bus->should_exit) {
+
+        if (!ebus_receive(bus)) {
+            /* NOTE:
+             * Announce that the receiver is going to sleep and then check the
+             * ring once more. A producer which has published a slot after the
+             * check will see the waiting flag and wake up the receiver.
+             */
+            __atomic_store_n(&bus->ring->waiting, 1u, __ATOMIC_SEQ_CST);
+            EBUS_FENCE();
+
+            if (EBUS_LOAD(&ring_slot(bus->ring, bus->ring->tail)->seq) !=
+                (bus->ring->tail + 1u) && !bus->should_exit) {
+                ring_wait(bus->ring);
+            }
+            __atomic_store_n(&bus->ring->waiting, 0u, __ATOMIC_SEQ_CST);
+        }
+    }
+
+    return (NULL);
+}
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+nerror nebus_open(struct nebus * bus, const char * name, uint32_t slots,
+        size_t slot_size)
+{
+    struct nebus_ring *         ring;
+    size_t                      stride;
+    size_t                      map_size;
+    uint32_t                    cnt;
+    int                         fd;
+
+    NREQUIRE(bus);
+    NREQUIRE(NSIGNATURE_OF(bus) != NSIGNATURE_EBUS);
+    NREQUIRE(name);
+
+    if ((slots < 2u) || !N_IS_POWEROF_2(slots)) {
+
+        return (NERROR_ARG_INVALID);
+    }
+    stride   = NALIGN_UP(sizeof(struct ebus_slot) + slot_size, EBUS_CACHE_LINE);
+    map_size = ring_header_size() + stride * slots;
+    /* NOTE:
+     * The ring is created exclusively. Opening an existing object would
+     * reinitialize a ring which producers still have mapped.
+     */
+    fd       = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (fd == -1) {
+
+        return (errno == EEXIST ? NERROR_NOT_PERMITTED : NERROR_NO_RESOURCE);
+    }
+
+    if (ftruncate(fd, (off_t)map_size) == -1) {
+        close(fd);
+        shm_unlink(name);
+
+        return (NERROR_NO_RESOURCE);
+    }
+    ring = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ring == MAP_FAILED) {
+        shm_unlink(name);
+
+        return (NERROR_NO_RESOURCE);
+    }
+    ring->mask    = slots - 1u;
+    ring->stride  = (uint32_t)stride;
+    ring->waiting = 0u;
+    ring->head    = 0u;
+    ring->tail    = 0u;
+
+    for (cnt = 0u; cnt < slots; cnt++) {
+        ring_slot(ring, cnt)->seq = cnt;
+    }
+    EBUS_STORE(&ring->magic, EBUS_MAGIC);
+
+    bus->ring        = ring;
+    bus->map_size    = map_size;
+    bus->name        = name;
+    bus->should_exit = false;
+    memset(bus->epa, 0, sizeof(bus->epa));
+
+    NOBLIGATION(NSIGNATURE_IS(bus, NSIGNATURE_EBUS));
+
+    if (pthread_create(&bus->thread, NULL, ebus_thread, bus) != 0) {
+        NOBLIGATION(NSIGNATURE_IS(bus, ~NSIGNATURE_EBUS));
+        munmap(ring, map_size);
+        shm_unlink(name);
+
+        return (NERROR_NO_RESOURCE);
+    }
+
+    return (NERROR_NONE);
+}
+
+
+
+void nebus_close(struct nebus * bus)
+{
+    NREQUIRE(N_IS_EBUS_OBJECT(bus));
+
+    bus->should_exit = true;
+    __atomic_store_n(&bus->ring->waiting, 0u, __ATOMIC_SEQ_CST);
+    ring_wake(bus->ring);
+    pthread_join(bus->thread, NULL);
+    munmap(bus->ring, bus->map_size);
+    shm_unlink(bus->name);
+
+    NOBLIGATION(NSIGNATURE_IS(bus, ~NSIGNATURE_EBUS));
+}
+
+
+
+void nebus_bind(struct nebus * bus, uint16_t epa_id, struct nepa * epa)
+{
+    NREQUIRE(N_IS_EBUS_OBJECT(bus));
+    NREQUIRE(epa_id < CONFIG_EBUS_EPA_IDS);
+    NREQUIRE(!epa || N_IS_EPA_OBJECT(epa));
+
+    __atomic_store_n(&bus->epa[epa_id], epa, __ATOMIC_RELEASE);
+}
+
+
+
+nerror nebus_proxy_open(struct nebus_proxy * proxy, const char * name,
+        uint16_t epa_id)
+{
+    struct nebus_ring *         ring;
+    struct stat                 info;
+    int                         fd;
+
+    NREQUIRE(proxy);
+    NREQUIRE(NSIGNATURE_OF(proxy) != NSIGNATURE_EBUS);
+    NREQUIRE(name);
+
+    fd = shm_open(name, O_RDWR, 0);
+
+    if (fd == -1) {
+
+        return (NERROR_OBJECT_NFOUND);
+    }
+
+    if ((fstat(fd, &info) == -1) ||
+        ((size_t)info.st_size < ring_header_size())) {
+        close(fd);
+
+        return (NERROR_OBJECT_NFOUND);
+    }
+    ring = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+        fd, 0);
+    close(fd);
+
+    if (ring == MAP_FAILED) {
+
+        return (NERROR_NO_RESOURCE);
+    }
+
+    if (EBUS_LOAD(&ring->magic) != EBUS_MAGIC) {
+        munmap(ring, (size_t)info.st_size);
+
+        return (NERROR_OBJECT_NFOUND);
+    }
+    memset(&proxy->epa, 0, sizeof(proxy->epa));
+    proxy->epa.proxy = proxy;
+    proxy->ring      = ring;
+    proxy->map_size  = (size_t)info.st_size;
+    proxy->epa_id    = epa_id;
+
+    NOBLIGATION(NSIGNATURE_IS(&proxy->epa, NSIGNATURE_EPA));
+    NOBLIGATION(NSIGNATURE_IS(proxy, NSIGNATURE_EBUS));
+
+    return (NERROR_NONE);
+}
+
+
+
+void nebus_proxy_close(struct nebus_proxy * proxy)
+{
+    NREQUIRE(N_IS_EBUS_OBJECT(proxy));
+
+    munmap(proxy->ring, proxy->map_size);
+
+    NOBLIGATION(NSIGNATURE_IS(&proxy->epa, ~NSIGNATURE_EPA));
+    NOBLIGATION(NSIGNATURE_IS(proxy, ~NSIGNATURE_EBUS));
+}
+
+
+
+nerror nebus_send_i(struct nebus_proxy * proxy, const struct nevent * event)
+{
+    struct nebus_ring *         ring;
+    struct ebus_slot *          slot;
+    uint64_t                    pos;
+    size_t                      size;
+    nerror                      error;
+
+    NREQUIRE(N_IS_EBUS_OBJECT(proxy));
+    NREQUIRE(N_IS_EVENT_OBJECT(event));
+    NREQUIRE(event->size >= sizeof(struct nevent));
+
+    ring = proxy->ring;
+    size = event->size - sizeof(struct nevent);
+
+    if (size > (ring->stride - sizeof(struct ebus_slot))) {
+        error = NERROR_ARG_OUT_OF_RANGE;
+
+        goto EXIT;
+    }
+    pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+    for (;;) {
+        int64_t                 diff;
+
+        slot = ring_slot(ring, pos);
+        diff = (int64_t)(EBUS_LOAD(&slot->seq) - pos);
+
+        if (diff == 0) {
+
+            if (EBUS_CAS(&ring->head, &pos, pos + 1u)) {
+                break;
+            }
+        } else if (diff < 0) {
+            error = NERROR_NO_RESOURCE;
+
+            goto EXIT;
+        } else {
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+    slot->epa_id = proxy->epa_id;
+    slot->id     = (uint16_t)event->id;
+    slot->size   = (uint32_t)size;
+    memcpy(slot + 1, event + 1, size);
+    EBUS_STORE(&slot->seq, pos + 1u);
+    EBUS_FENCE();
+
+    if (__atomic_exchange_n(&ring->waiting, 0u, __ATOMIC_SEQ_CST) != 0u) {
+        ring_wake(ring);
+    }
+    error = NERROR_NONE;
+EXIT:
+    /* NOTE:
+     * The event data is copied, so the local event is not needed anymore.
+     */
+    nevent_destroy_i(event);
+
+    return (error);
+}
+
+#endif /* (CONFIG_EBUS == 1) */
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of ebus.c
+ ******************************************************************************/
@@ -36,14 +36,89 @@
 #include "mm/mem.h"
 #include "port/core.h"
 
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+#include "ep/etimer.h"
+#endif
+
+#if (CONFIG_EBUS == 1)
+#include "ep/ebus.h"
+#endif
+
+#if (CONFIG_ETRACE == 1)
+#include "ep/etrace.h"
+#endif
+
+#if (CONFIG_EPA_SCRATCH_SIZE != 0u)
+#include "mm/arena.h"
+#endif
+
 /*=========================================================  LOCAL MACRO's  ==*/
+
+/**@brief       Release everything a handler has allocated from scratch arena
+ */
+#if (CONFIG_EPA_SCRATCH_SIZE != 0u)
+#define EPA_SCRATCH_RESET()                                                     \
+    narena_reset(NARENA_FROM_BUNDLE(&g_epa_scratch))
+#else
+#define EPA_SCRATCH_RESET()             (void)0
+#endif
+
 /*======================================================  LOCAL DATA TYPES  ==*/
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+/**@brief       Dispatch events of all expired event timers
+ */
+static void epa_dispatch_timers_i(struct nepa * epa, ncore_lock * lock);
+#endif
+
 /*=======================================================  LOCAL VARIABLES  ==*/
+
+#if (CONFIG_EPA_SCRATCH_SIZE != 0u)
+/**@brief       Scratch arena shared by all EPAs
+ * @details     Only one handler is executed at a time, so a single arena is
+ *              enough.
+ */
+static NARENA_BUNDLE_DEFINE(g_epa_scratch, CONFIG_EPA_SCRATCH_SIZE);
+#endif
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
 
 
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+static void epa_dispatch_timers_i(struct nepa * epa, ncore_lock * lock)
+{
+    struct ndlist               batch;
+
+    /* NOTE:
+     * Take over the whole expiry list. Timers which expire while the batch
+     * is dispatched start a new list and insert the thread again.
+     */
+    ndlist_init(&batch);
+    ndlist_add_after(&epa->expired, &batch);
+    ndlist_remove(&epa->expired);
+    ndlist_init(&epa->expired);
+
+    while (!ndlist_is_empty(&batch)) {
+        struct netimer *        timer;
+
+        timer = PORT_C_CONTAINER_OF(ndlist_next(&batch), struct netimer,
+            expired);
+        ndlist_remove(&timer->expired);
+        ncore_lock_exit(lock);
+#if (CONFIG_ETRACE == 1)
+        netrace_record(epa, &timer->event);
+#endif
+        nsm_dispatch(epa->sm, &timer->event);
+        EPA_SCRATCH_RESET();
+        ncore_lock_enter(lock);
+    }
+}
+#endif
+
+
+
 static void
 epa_dispatch_i(struct nthread * thread, ncore_lock * lock)
 {
@@ -51,13 +126,29 @@ epa_dispatch_i(struct nthread * thread, ncore_lock * lock)
     const struct nevent *       event;
                                                            
     epa = NP_THREAD_TO_EPA(thread);                        /* Get EPA pointer */
+
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+    /* NOTE:
+     * Expired timers are dispatched ahead of events waiting in the queue.
+     */
+    if (!ndlist_is_empty(&epa->expired)) {
+        epa_dispatch_timers_i(epa, lock);
+        nthread_remove_i(thread);
+
+        return;
+    }
+#endif
     event = nqueue_get(epa->queue);              /* Get Event pointer */
     ncore_lock_exit(lock);
+#if (CONFIG_ETRACE == 1)
+    netrace_record(epa, event);
+#endif
     /* ********************************************************************** *
      * NOTE: Dispatch the state machine. This is a good place to              *
      * place a breakpoint when debugging state machines.                      *
      * ********************************************************************** */
     nsm_dispatch(epa->sm, event);
+    EPA_SCRATCH_RESET();
     nevent_ref_down(event);
     ncore_lock_enter(lock);
     nevent_destroy_i(event);
@@ -71,6 +162,7 @@ epa_init_i(struct nthread * thread, ncore_lock * lock)
 {
     ncore_lock_exit(lock);
     nsm_dispatch(NP_THREAD_TO_EPA(thread)->sm, nsm_event(NSM_INIT));
+    EPA_SCRATCH_RESET();
     ncore_lock_enter(lock);
     nthread_remove_i(thread);                             /* Block the thread */
     nthread_set_dispatch(thread, epa_dispatch_i);
@@ -106,6 +198,9 @@ struct nepa * nepa_alloc(struct nmem * mem, const char * name, size_t q_size,
     epa->mem = mem;
     epa->sm = sm;
     epa->queue = queue;
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+    ndlist_init(&epa->expired);
+#endif
     nthread_init(&epa->thread, name, prio, NULL);
     
     NOBLIGATION(NSIGNATURE_IS(epa, NSIGNATURE_EPA));
@@ -195,6 +290,15 @@ void nepa_delete_storage(void * storage)
 
 
 
+#if (CONFIG_EPA_SCRATCH_SIZE != 0u)
+struct nmem * nepa_scratch(void)
+{
+    return (NARENA_FROM_BUNDLE(&g_epa_scratch));
+}
+#endif
+
+
+
 nerror nepa_defer_event(struct nqueue * queue, const struct nevent * event)
 {
     /* NOTE:
@@ -274,6 +378,15 @@ nerror nepa_send_event_i(struct nepa * epa, const struct nevent * event)
     NREQUIRE(N_IS_EVENT_OBJECT(event));
     NREQUIRE(ncore_is_lock_valid());
 
+#if (CONFIG_EBUS == 1)
+    if (epa->proxy) {
+        error = nebus_send_i(epa->proxy, event);
+        NENSURE(error == NERROR_NONE);
+
+        return (error);
+    }
+#endif
+
     if (nevent_ref(event) < NEVENT_REF_LIMIT) {
         nevent_ref_up(event);
 
@@ -319,6 +432,15 @@ nerror nepa_send_event_ahead_i(struct nepa * epa, struct nevent * event)
     NREQUIRE(N_IS_EVENT_OBJECT(event));
     NREQUIRE(ncore_is_lock_valid());
 
+#if (CONFIG_EBUS == 1)
+    if (epa->proxy) {
+        error = nebus_send_i(epa->proxy, event);
+        NENSURE(error == NERROR_NONE);
+
+        return (error);
+    }
+#endif
+
     if (nevent_ref(event) < NEVENT_REF_LIMIT) {
         nevent_ref_up(event);
 
@@ -0,0 +1,308 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Elastic pool memory management implementation
+ * @addtogroup  mm_epool
+ *********************************************************************//** @{ */
+/**@defgroup    mm_epool_impl Implementation
+ * @brief       Elastic pool memory management implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <string.h>
+
+#include "port/core.h"
+#include "base/debug.h"
+#include "base/bitop.h"
+#include "mm/epool.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define CHUNK_HEADER_SIZE                                                   \
+    NALIGN_UP(sizeof(struct nepool_chunk), (size_t)NCPU_DATA_ALIGNMENT)
+
+#define CHUNK_BLOCKS(chunk)             ((uint8_t *)(chunk) + CHUNK_HEADER_SIZE)
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/**@brief       Chunk header, placed at the beginning of each chunk
+ */
+struct nepool_chunk
+{
+    struct nepool_chunk *       next;
+    uint32_t                    n_blocks;
+    uint32_t                    n_free;     /**<@brief Used only by trim  */
+};
+
+/**@brief       Free block header
+ */
+struct epool_block
+{
+    struct epool_block *        next;
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static struct nepool_chunk * chunk_create(struct nepool * epool);
+
+static struct nepool_chunk * chunk_lookup(struct nepool * epool,
+        const void * mem);
+
+static void * epool_alloc(struct nmem * mem_class, size_t size);
+
+static void epool_free(struct nmem * mem_class, void * mem);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static struct nepool_chunk * chunk_create(struct nepool * epool)
+{
+    struct nepool_chunk *       chunk;
+    uint32_t                    n_blocks;
+    uint32_t                    cnt;
+
+    n_blocks = epool->grow;
+
+    if (epool->max_blocks != NEPOOL_NO_LIMIT) {
+
+        if (epool->mem_class.no_blocks >= epool->max_blocks) {
+
+            return (NULL);
+        }
+
+        if (epool->max_blocks - epool->mem_class.no_blocks < n_blocks) {
+            n_blocks = epool->max_blocks - epool->mem_class.no_blocks;
+        }
+    }
+    chunk = nmem_alloc_i(epool->parent,
+        CHUNK_HEADER_SIZE + n_blocks * epool->block_size);
+
+    if (chunk == NULL) {
+
+        return (NULL);
+    }
+    chunk->next     = epool->chunks;
+    chunk->n_blocks = n_blocks;
+    epool->chunks   = chunk;
+
+                                        /* Link blocks in address order.      */
+    for (cnt = n_blocks; cnt-- != 0u;) {
+        struct epool_block *    block;
+
+        block = (struct epool_block *)
+            (CHUNK_BLOCKS(chunk) + cnt * epool->block_size);
+        block->next           = epool->mem_class.base;
+        epool->mem_class.base = block;
+    }
+    epool->mem_class.size      += n_blocks * epool->block_size;
+    epool->mem_class.free      += n_blocks * epool->block_size;
+    epool->mem_class.no_blocks += n_blocks;
+
+    return (chunk);
+}
+
+
+
+static struct nepool_chunk * chunk_lookup(struct nepool * epool,
+        const void * mem)
+{
+    struct nepool_chunk *       chunk;
+
+    for (chunk = epool->chunks; chunk; chunk = chunk->next) {
+
+        if (((const uint8_t *)mem >= CHUNK_BLOCKS(chunk)) &&
+            ((const uint8_t *)mem <  CHUNK_BLOCKS(chunk) +
+                chunk->n_blocks * epool->block_size)) {
+
+            return (chunk);
+        }
+    }
+
+    return (NULL);
+}
+
+
+
+static void * epool_alloc(struct nmem * mem_class, size_t size)
+{
+    struct nepool *             epool;
+    struct epool_block *        block;
+
+    NREQUIRE(NSIGNATURE_OF(mem_class) == NSIGNATURE_EPOOL);
+    NREQUIRE(ncore_is_lock_valid());
+
+    epool = PORT_C_CONTAINER_OF(mem_class, struct nepool, mem_class);
+
+    NREQUIRE(size <= epool->block_size);
+
+    (void)size;
+
+    if ((mem_class->base == NULL) && (chunk_create(epool) == NULL)) {
+
+        return (NULL);
+    }
+    block            = mem_class->base;
+    mem_class->base  = block->next;
+    mem_class->free -= epool->block_size;
+
+    return ((void *)block);
+}
+
+
+
+static void epool_free(struct nmem * mem_class, void * mem)
+{
+    struct nepool *             epool;
+    struct epool_block *        block;
+
+    NREQUIRE(NSIGNATURE_OF(mem_class) == NSIGNATURE_EPOOL);
+    NREQUIRE(mem);
+    NREQUIRE(ncore_is_lock_valid());
+
+    epool            = PORT_C_CONTAINER_OF(mem_class, struct nepool, mem_class);
+    block            = (struct epool_block *)mem;
+    block->next      = mem_class->base;
+    mem_class->base  = block;
+    mem_class->free += epool->block_size;
+}
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+void nepool_init(struct nepool * epool, struct nmem * parent,
+        size_t block_size, uint32_t grow, uint32_t max_blocks)
+{
+    NREQUIRE(epool);
+    NREQUIRE(NSIGNATURE_OF(&epool->mem_class) != NSIGNATURE_EPOOL);
+    NREQUIRE(N_IS_MEM_OBJECT(parent));
+    NREQUIRE(block_size != 0u);
+    NREQUIRE(grow != 0u);
+
+    if (block_size < sizeof(struct epool_block)) {
+        block_size = sizeof(struct epool_block);
+    }
+    epool->mem_class.vf_alloc         = epool_alloc;
+    epool->mem_class.vf_free          = epool_free;
+    epool->mem_class.vf_alloc_aligned = NULL;
+    epool->mem_class.vf_realloc       = NULL;
+    epool->mem_class.vf_free_sized    = NULL;
+    epool->mem_class.base             = NULL;
+    epool->mem_class.cursor           = NULL;
+    epool->mem_class.free             = 0u;
+    epool->mem_class.size             = 0u;
+    epool->mem_class.no_blocks        = 0u;
+#if (CONFIG_MEM_STATS == 1)
+    epool->mem_class.vf_largest       = NULL;
+    memset(&epool->mem_class.stats, 0, sizeof(epool->mem_class.stats));
+#endif
+    epool->parent                     = parent;
+    epool->chunks                     = NULL;
+    epool->block_size = NALIGN_UP(block_size, (size_t)NCPU_DATA_ALIGNMENT);
+    epool->grow                       = grow;
+    epool->max_blocks                 = max_blocks;
+
+    NOBLIGATION(NSIGNATURE_IS(&epool->mem_class, NSIGNATURE_EPOOL));
+}
+
+
+
+uint32_t nepool_trim_i(struct nepool * epool)
+{
+    struct nepool_chunk *       chunk;
+    struct nepool_chunk **      link;
+    struct epool_block **       block;
+    uint32_t                    released;
+
+    NREQUIRE(NSIGNATURE_OF(&epool->mem_class) == NSIGNATURE_EPOOL);
+    NREQUIRE(ncore_is_lock_valid());
+
+    for (chunk = epool->chunks; chunk; chunk = chunk->next) {
+        chunk->n_free = 0u;
+    }
+
+    for (block = (struct epool_block **)&epool->mem_class.base; *block;
+         block = &(*block)->next) {
+        chunk_lookup(epool, *block)->n_free++;
+    }
+
+    /* NOTE:
+     * The oldest chunk is the last one in the list and it is never released,
+     * so mark it as busy.
+     */
+    for (chunk = epool->chunks; chunk && chunk->next; chunk = chunk->next) {
+    }
+
+    if (chunk) {
+        chunk->n_free = 0u;
+    }
+                                        /* Unlink free blocks of idle chunks. */
+    for (block = (struct epool_block **)&epool->mem_class.base; *block;) {
+        chunk = chunk_lookup(epool, *block);
+
+        if (chunk->n_free == chunk->n_blocks) {
+            *block = (*block)->next;
+        } else {
+            block  = &(*block)->next;
+        }
+    }
+    released = 0u;
+
+    for (link = &epool->chunks; *link;) {
+        chunk = *link;
+
+        if (chunk->n_free == chunk->n_blocks) {
+            *link = chunk->next;
+            epool->mem_class.size      -= chunk->n_blocks * epool->block_size;
+            epool->mem_class.free      -= chunk->n_blocks * epool->block_size;
+            epool->mem_class.no_blocks -= chunk->n_blocks;
+            nmem_free_i(epool->parent, chunk);
+            released++;
+        } else {
+            link  = &chunk->next;
+        }
+    }
+
+    return (released);
+}
+
+
+
+uint32_t nepool_trim(struct nepool * epool)
+{
+    ncore_lock                  sys_lock;
+    uint32_t                    released;
+
+    ncore_lock_enter(&sys_lock);
+    released = nepool_trim_i(epool);
+    ncore_lock_exit(&sys_lock);
+
+    return (released);
+}
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of epool.c
+ ******************************************************************************/
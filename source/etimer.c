@@ -36,12 +36,68 @@
 #include "ep/etimer.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
+
+#if (CONFIG_ETIMER_DELAYED_SLOTS != 0u)
+/**@brief       Marks the end of delayed slot free list
+ */
+#define DELAYED_NONE                    UINT16_MAX
+#endif
+
 /*======================================================  LOCAL DATA TYPES  ==*/
+
+#if (CONFIG_ETIMER_DELAYED_SLOTS != 0u)
+/**@brief       Delayed event slot
+ */
+struct etimer_delayed
+{
+    struct ntimer               timer;
+    struct nepa *               epa;
+    const struct nevent *       event;  /**<@brief NULL when slot is free */
+    uint16_t                    next;   /**<@brief Next free slot         */
+    uint16_t                    gen;    /**<@brief Handle generation      */
+};
+
+/**@brief       Pool of delayed event slots
+ * @details     Slots which were never used are taken from @c unused cursor,
+ *              released slots are kept in free list.
+ */
+struct etimer_delayed_pool
+{
+    struct etimer_delayed       slot[CONFIG_ETIMER_DELAYED_SLOTS];
+    uint32_t                    unused;
+    uint16_t                    free;
+};
+#endif
+
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
 
 static void etimer_handler(void * arg);
 
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+static void etimer_unlink_i(struct netimer * timer);
+#endif
+
+#if (CONFIG_ETIMER_DELAYED_SLOTS != 0u)
+static struct etimer_delayed * delayed_alloc_i(void);
+
+static void delayed_free_i(struct etimer_delayed * delayed);
+
+static void delayed_handler(void * arg);
+
+static nerror delayed_start_i(struct nepa * epa, const struct nevent * event,
+        uint32_t tick, ndelayed * handle);
+#endif
+
 /*=======================================================  LOCAL VARIABLES  ==*/
+
+#if (CONFIG_ETIMER_DELAYED_SLOTS != 0u)
+static struct etimer_delayed_pool g_delayed =
+{
+    .unused = 0u,
+    .free   = DELAYED_NONE
+};
+#endif
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
 
@@ -49,9 +105,142 @@ static void etimer_handler(void * arg)
 {
     struct netimer *            timer = arg;
 
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+#if (CONFIG_EBUS == 1)
+    if (timer->epa->proxy) {
+        nepa_send_event_i(timer->epa, &timer->event);
+
+        return;
+    }
+#endif
+    /* NOTE:
+     * Only the first timer in EPA expiry list inserts the EPA thread, all
+     * timers in the list are dispatched by a single EPA dispatch. A timer
+     * which is already in the list is not added twice.
+     */
+    if (ndlist_is_empty(&timer->expired)) {
+
+        if (ndlist_is_empty(&timer->epa->expired)) {
+            nthread_insert_i(&timer->epa->thread);
+        }
+        ndlist_add_before(&timer->epa->expired, &timer->expired);
+    }
+#else
     nepa_send_event_i(timer->epa, &timer->event);
+#endif
+}
+
+
+
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+/**@brief       Take the timer out of EPA expiry list
+ * @details     The EPA thread was inserted once for the whole expiry list, so
+ *              it is removed when the last pending timer is taken out. A timer
+ *              which is in a batch already taken over by the EPA dispatch is
+ *              just unlinked.
+ */
+static void etimer_unlink_i(struct netimer * timer)
+{
+    bool                        is_pending;
+
+    if (ndlist_is_empty(&timer->expired)) {
+
+        return;
+    }
+    is_pending = !ndlist_is_empty(&timer->epa->expired);
+    ndlist_remove(&timer->expired);
+
+    if (is_pending && ndlist_is_empty(&timer->epa->expired)) {
+        nthread_remove_i(&timer->epa->thread);
+    }
+}
+#endif
+
+
+
+#if (CONFIG_ETIMER_DELAYED_SLOTS != 0u)
+static struct etimer_delayed * delayed_alloc_i(void)
+{
+    struct etimer_delayed *     delayed;
+
+    if (g_delayed.free != DELAYED_NONE) {
+        delayed        = &g_delayed.slot[g_delayed.free];
+        g_delayed.free = delayed->next;
+    } else if (g_delayed.unused < CONFIG_ETIMER_DELAYED_SLOTS) {
+        delayed = &g_delayed.slot[g_delayed.unused++];
+        ntimer_init(&delayed->timer);
+    } else {
+        delayed = NULL;
+    }
+
+    return (delayed);
 }
 
+
+
+static void delayed_free_i(struct etimer_delayed * delayed)
+{
+    delayed->event = NULL;
+    delayed->gen++;
+    delayed->next  = g_delayed.free;
+    g_delayed.free = (uint16_t)(delayed - &g_delayed.slot[0]);
+}
+
+
+
+static void delayed_handler(void * arg)
+{
+    struct etimer_delayed *     delayed = arg;
+    struct nepa *               epa;
+    const struct nevent *       event;
+
+    epa   = delayed->epa;
+    event = delayed->event;
+    delayed_free_i(delayed);
+    nevent_ref_down(event);
+    nepa_send_event_i(epa, event);
+}
+
+
+
+static nerror delayed_start_i(struct nepa * epa, const struct nevent * event,
+        uint32_t tick, ndelayed * handle)
+{
+    struct etimer_delayed *     delayed;
+
+    if (handle) {
+        *handle = NDELAYED_INVALID;
+    }
+
+    if (tick == 0u) {
+
+        return (nepa_send_event_i(epa, event));
+    }
+    delayed = delayed_alloc_i();
+
+    if (!delayed) {
+        nevent_destroy_i(event);
+
+        return (NERROR_NO_RESOURCE);
+    }
+    /* NOTE:
+     * Hold a reference so the event survives until it is delivered.
+     */
+    nevent_ref_up(event);
+    delayed->epa   = epa;
+    delayed->event = event;
+    ntimer_start_i(&delayed->timer, tick, 0u, delayed_handler, delayed,
+            NTIMER_ATTR_ONE_SHOT);
+
+    if (handle) {
+        *handle = ((uint32_t)delayed->gen << 16) |
+            (uint32_t)(delayed - &g_delayed.slot[0] + 1);
+    }
+
+    return (NERROR_NONE);
+}
+#endif
+
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
 
 
@@ -61,6 +250,12 @@ void netimer_init(
 	NREQUIRE(!N_IS_ETIMER_OBJECT(timer));
 
     ntimer_init(&timer->timer);
+#if (CONFIG_HRTIMER == 1)
+    nhrtimer_init(&timer->hrtimer);
+#endif
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+    ndlist_init(&timer->expired);
+#endif
     timer->event  = g_default_event;
     timer->epa = nepa_get_current();
 
@@ -72,16 +267,29 @@ void netimer_init(
 void netimer_term(
     struct netimer *            timer)
 {
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+    ncore_lock                  lock;
+#endif
+
     NREQUIRE(N_IS_ETIMER_OBJECT(timer));
 
     ntimer_term(&timer->timer);
+#if (CONFIG_HRTIMER == 1)
+    nhrtimer_cancel(&timer->hrtimer);
+#endif
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+    ncore_lock_enter(&lock);
+    etimer_unlink_i(timer);
+    ncore_lock_exit(&lock);
+#endif
 
     NOBLIGATION(NSIGNATURE_IS(timer, ~NSIGNATURE_ETIMER));
 }
 
 
 
-void netimer_after(struct netimer * timer, uint32_t tick, uint16_t event_id)
+void netimer_after(struct netimer * timer, uint32_t tick, uint32_t slack,
+        uint16_t event_id)
 {
     ncore_lock                  lock;
 
@@ -89,15 +297,19 @@ void netimer_after(struct netimer * timer, uint32_t tick, uint16_t event_id)
 
     ncore_lock_enter(&lock);
     ntimer_cancel_i(&timer->timer);
+#if (CONFIG_HRTIMER == 1)
+    nhrtimer_cancel_i(&timer->hrtimer);
+#endif
     timer->event.id = event_id;
-    ntimer_start_i(&timer->timer, tick, etimer_handler, timer,
+    ntimer_start_i(&timer->timer, tick, slack, etimer_handler, timer,
             NTIMER_ATTR_ONE_SHOT);
     ncore_lock_exit(&lock);
 }
 
 
 
-void netimer_every(struct netimer * timer, uint32_t tick, uint16_t event_id)
+void netimer_every(struct netimer * timer, uint32_t tick, uint32_t slack,
+        uint16_t event_id)
 {
     ncore_lock                  lock;
 
@@ -105,10 +317,14 @@ void netimer_every(struct netimer * timer, uint32_t tick, uint16_t event_id)
 
     ncore_lock_enter(&lock);
     ntimer_cancel_i(&timer->timer);
+#if (CONFIG_HRTIMER == 1)
+    nhrtimer_cancel_i(&timer->hrtimer);
+#endif
     timer->event.id = event_id;
     ntimer_start_i(
             &timer->timer,
             tick,
+            slack,
             etimer_handler,
             timer,
             NTIMER_ATTR_REPEAT);
@@ -119,6 +335,10 @@ void netimer_every(struct netimer * timer, uint32_t tick, uint16_t event_id)
 
 void netimer_cancel(struct netimer * timer)
 {
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+    ncore_lock                  lock;
+#endif
+
 	NREQUIRE(N_IS_ETIMER_OBJECT(timer));
 
     /* Make this event NULL event. This is used to NULLify event even if it was
@@ -126,6 +346,14 @@ void netimer_cancel(struct netimer * timer)
      */
     timer->event.id = NSM_NULL;
     ntimer_cancel(&timer->timer);
+#if (CONFIG_HRTIMER == 1)
+    nhrtimer_cancel(&timer->hrtimer);
+#endif
+#if (CONFIG_ETIMER_AGGREGATE == 1)
+    ncore_lock_enter(&lock);
+    etimer_unlink_i(timer);
+    ncore_lock_exit(&lock);
+#endif
 }
 
 
@@ -134,6 +362,13 @@ bool netimer_is_running_i(const struct netimer * timer)
 {
 	NREQUIRE(N_IS_ETIMER_OBJECT(timer));
 
+#if (CONFIG_HRTIMER == 1)
+    if (nhrtimer_is_running_i(&timer->hrtimer)) {
+
+        return (true);
+    }
+#endif
+
     return (ntimer_is_running_i(&timer->timer));
 }
 
@@ -146,6 +381,125 @@ uint32_t netimer_remaining(const struct netimer * timer)
     return (ntimer_remaining(&timer->timer));
 }
 
+
+
+#if (CONFIG_HRTIMER == 1)
+nerror netimer_after_ns(struct netimer * timer, uint64_t ns, uint64_t slack,
+        uint16_t event_id)
+{
+    ncore_lock                  lock;
+    nerror                      error;
+
+    NREQUIRE(N_IS_ETIMER_OBJECT(timer));
+
+    ncore_lock_enter(&lock);
+    ntimer_cancel_i(&timer->timer);
+    nhrtimer_cancel_i(&timer->hrtimer);
+    timer->event.id = event_id;
+    error = nhrtimer_start_i(&timer->hrtimer, nhrtimer_now() + ns, slack, 0u,
+            etimer_handler, timer);
+    ncore_lock_exit(&lock);
+
+    return (error);
+}
+
+
+
+nerror netimer_every_ns(struct netimer * timer, uint64_t ns, uint64_t slack,
+        uint16_t event_id)
+{
+    ncore_lock                  lock;
+    nerror                      error;
+
+    NREQUIRE(N_IS_ETIMER_OBJECT(timer));
+    NREQUIRE(ns != 0u);
+
+    ncore_lock_enter(&lock);
+    ntimer_cancel_i(&timer->timer);
+    nhrtimer_cancel_i(&timer->hrtimer);
+    timer->event.id = event_id;
+    error = nhrtimer_start_i(&timer->hrtimer, nhrtimer_now() + ns, slack,
+            ns, etimer_handler, timer);
+    ncore_lock_exit(&lock);
+
+    return (error);
+}
+#endif
+
+
+
+#if (CONFIG_ETIMER_DELAYED_SLOTS != 0u)
+nerror nepa_send_event_after(struct nepa * epa, const struct nevent * event,
+        uint32_t tick, ndelayed * handle)
+{
+    ncore_lock                  lock;
+    nerror                      error;
+
+    NREQUIRE(N_IS_EPA_OBJECT(epa));
+    NREQUIRE(N_IS_EVENT_OBJECT(event));
+
+    ncore_lock_enter(&lock);
+    error = delayed_start_i(epa, event, tick, handle);
+    ncore_lock_exit(&lock);
+
+    return (error);
+}
+
+
+
+nerror nepa_send_event_at(struct nepa * epa, const struct nevent * event,
+        uint32_t tick, ndelayed * handle)
+{
+    ncore_lock                  lock;
+    int32_t                     delta;
+    nerror                      error;
+
+    NREQUIRE(N_IS_EPA_OBJECT(epa));
+    NREQUIRE(N_IS_EVENT_OBJECT(event));
+
+    ncore_lock_enter(&lock);
+    delta = (int32_t)(tick - ntimer_get_tick());
+    error = delayed_start_i(epa, event, delta > 0 ? (uint32_t)delta : 0u,
+            handle);
+    ncore_lock_exit(&lock);
+
+    return (error);
+}
+
+
+
+nerror nepa_cancel_event(ndelayed handle)
+{
+    ncore_lock                  lock;
+    struct etimer_delayed *     delayed;
+    uint32_t                    idx;
+    nerror                      error;
+
+    idx = handle & 0xffffu;
+
+    if ((idx == 0u) || (idx > CONFIG_ETIMER_DELAYED_SLOTS)) {
+
+        return (NERROR_OBJECT_NFOUND);
+    }
+    delayed = &g_delayed.slot[idx - 1u];
+    error   = NERROR_OBJECT_NFOUND;
+    ncore_lock_enter(&lock);
+
+    if (delayed->event && (delayed->gen == (uint16_t)(handle >> 16))) {
+        const struct nevent *   event = delayed->event;
+
+        ntimer_cancel_i(&delayed->timer);
+        delayed_free_i(delayed);
+        nevent_ref_down(event);
+        nevent_destroy_i(event);
+        error = NERROR_NONE;
+    }
+    ncore_lock_exit(&lock);
+
+    return (error);
+}
+#endif
+
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 /** @endcond *//** @} *//** @} *//*********************************************
  * END of equeue.c
@@ -0,0 +1,446 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Event trace recording and replay implementation
+ * @addtogroup  event_trace
+ *********************************************************************//** @{ */
+/**@defgroup    event_trace_impl Implementation
+ * @brief       Event trace recording and replay Implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#define _GNU_SOURCE
+
+#include "base/config.h"
+
+#if (CONFIG_ETRACE == 1)
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "base/debug.h"
+#include "ep/epa.h"
+#include "ep/event.h"
+#include "ep/etrace.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define ETRACE_MAGIC                    "NTRC"
+
+#define ETRACE_VERSION                  1u
+
+#define ETRACE_TAG_EPA                  1u
+
+#define ETRACE_TAG_EVENT                2u
+
+/**@brief       Longest EPA name which is written to a trace, longer names are
+ *              truncated
+ */
+#define ETRACE_NAME_MAX                 255u
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/**@brief       Recorder state
+ */
+struct etrace_recorder
+{
+    pthread_mutex_t             lock;
+    FILE *                      file;
+    uint64_t                    last_ns;/**<@brief Time of previous event */
+    size_t                      n_epas;
+                                        /**<@brief Already defined EPAs   */
+    const struct nepa *         epa[CONFIG_ETRACE_EPAS];
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static uint64_t etrace_now(void);
+
+static void put_varint(FILE * file, uint64_t value);
+
+/**@brief       Read a variable length integer
+ * @return      Returns false on end of file or corrupted value
+ */
+static bool get_varint(FILE * file, uint64_t * value);
+
+/**@brief       Get trace index of an EPA, writes EPA record on first use
+ * @return      Returns @ref CONFIG_ETRACE_EPAS when there is no free index.
+ */
+static size_t recorder_epa_index(const struct nepa * epa);
+
+static nerror replay_define_epa(struct netrace_replay * replay);
+
+static nerror replay_event(struct netrace_replay * replay,
+        enum netrace_pace pace, struct timespec * deadline);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static struct etrace_recorder   g_recorder =
+{
+    .lock   = PTHREAD_MUTEX_INITIALIZER,
+    .file   = NULL
+};
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static uint64_t etrace_now(void)
+{
+    struct timespec             now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+}
+
+
+
+static void put_varint(FILE * file, uint64_t value)
+{
+    while (value >= 0x80u) {
+        putc_unlocked((int)((value & 0x7fu) | 0x80u), file);
+        value >>= 7;
+    }
+    putc_unlocked((int)value, file);
+}
+
+
+
+static bool get_varint(FILE * file, uint64_t * value)
+{
+    uint32_t                    shift;
+    int                         byte;
+
+    *value = 0u;
+
+    for (shift = 0u; shift < 64u; shift += 7u) {
+        byte = getc_unlocked(file);
+
+        if (byte == EOF) {
+
+            return (false);
+        }
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80)) {
+
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+
+
+static size_t recorder_epa_index(const struct nepa * epa)
+{
+    size_t                      idx;
+    size_t                      name_len;
+
+    for (idx = 0u; idx < g_recorder.n_epas; idx++) {
+
+        if (g_recorder.epa[idx] == epa) {
+
+            return (idx);
+        }
+    }
+
+    if (idx == CONFIG_ETRACE_EPAS) {
+
+        return (idx);
+    }
+    g_recorder.epa[idx] = epa;
+    g_recorder.n_epas++;
+    name_len = epa->thread.name ? strlen(epa->thread.name) : 0u;
+
+    if (name_len > ETRACE_NAME_MAX) {
+        name_len = ETRACE_NAME_MAX;
+    }
+    putc_unlocked(ETRACE_TAG_EPA, g_recorder.file);
+    put_varint(g_recorder.file, idx);
+    put_varint(g_recorder.file, name_len);
+    fwrite(epa->thread.name, 1u, name_len, g_recorder.file);
+
+    return (idx);
+}
+
+
+
+static nerror replay_define_epa(struct netrace_replay * replay)
+{
+    char                        name[ETRACE_NAME_MAX + 1u];
+    uint64_t                    idx;
+    uint64_t                    name_len;
+    size_t                      cnt;
+
+    if (!get_varint(replay->file, &idx) ||
+        !get_varint(replay->file, &name_len) ||
+        (idx >= CONFIG_ETRACE_EPAS) || (name_len >= sizeof(name))) {
+
+        return (NERROR_OBJECT_INVALID);
+    }
+
+    if (fread(name, 1u, (size_t)name_len, replay->file) != name_len) {
+
+        return (NERROR_OBJECT_INVALID);
+    }
+    name[name_len] = '\0';
+    replay->map[idx] = NULL;
+
+    for (cnt = 0u; cnt < replay->n_epas; cnt++) {
+        const char *            epa_name = replay->epas[cnt]->thread.name;
+
+        if (epa_name && !strcmp(epa_name, name)) {
+            replay->map[idx] = replay->epas[cnt];
+
+            break;
+        }
+    }
+
+    return (NERROR_NONE);
+}
+
+
+
+static nerror replay_event(struct netrace_replay * replay,
+        enum netrace_pace pace, struct timespec * deadline)
+{
+    struct nevent *             event;
+    struct nepa *               epa;
+    uint64_t                    idx;
+    uint64_t                    delta_ns;
+    uint64_t                    id;
+    uint64_t                    size;
+
+    if (!get_varint(replay->file, &idx) ||
+        !get_varint(replay->file, &delta_ns) ||
+        !get_varint(replay->file, &id) ||
+        !get_varint(replay->file, &size) ||
+        (idx >= CONFIG_ETRACE_EPAS)) {
+
+        return (NERROR_OBJECT_INVALID);
+    }
+    epa   = replay->map[idx];
+    event = epa ? nevent_create(sizeof(struct nevent) + (size_t)size,
+        (uint16_t)id) : NULL;
+
+    if (!event) {
+        replay->dropped++;
+
+        if (fseek(replay->file, (long)size, SEEK_CUR) != 0) {
+
+            return (NERROR_OBJECT_INVALID);
+        }
+
+        return (NERROR_NONE);
+    }
+
+    if (fread(event + 1, 1u, (size_t)size, replay->file) != size) {
+        nevent_destroy(event);
+
+        return (NERROR_OBJECT_INVALID);
+    }
+
+    if (pace == NETRACE_PACE_RECORDED) {
+        delta_ns += (uint64_t)deadline->tv_nsec;
+        deadline->tv_sec  += (time_t)(delta_ns / 1000000000u);
+        deadline->tv_nsec  = (long)(delta_ns % 1000000000u);
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL)
+               != 0) {
+            /* Restart after a signal handler */
+        }
+    }
+    nepa_send_event(epa, event);
+
+    return (NERROR_NONE);
+}
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+nerror netrace_record_start(const char * path)
+{
+    FILE *                      file;
+
+    NREQUIRE(path);
+
+    file = fopen(path, "wb");
+
+    if (!file) {
+
+        return (NERROR_NO_RESOURCE);
+    }
+    fwrite(ETRACE_MAGIC, 1u, sizeof(ETRACE_MAGIC) - 1u, file);
+    putc(ETRACE_VERSION, file);
+
+    pthread_mutex_lock(&g_recorder.lock);
+    NREQUIRE(!g_recorder.file);
+    g_recorder.n_epas  = 0u;
+    g_recorder.last_ns = etrace_now();
+    g_recorder.file    = file;
+    pthread_mutex_unlock(&g_recorder.lock);
+
+    return (NERROR_NONE);
+}
+
+
+
+void netrace_record_stop(void)
+{
+    FILE *                      file;
+
+    pthread_mutex_lock(&g_recorder.lock);
+    file            = g_recorder.file;
+    g_recorder.file = NULL;
+    pthread_mutex_unlock(&g_recorder.lock);
+
+    if (file) {
+        fclose(file);
+    }
+}
+
+
+
+void netrace_record(const struct nepa * epa, const struct nevent * event)
+{
+    uint64_t                    now;
+    size_t                      idx;
+    size_t                      size;
+
+    /* NOTE:
+     * Unlocked read of file pointer keeps the cost of disabled recorder to a
+     * single load. The pointer is checked once more under the lock.
+     */
+    if (!__atomic_load_n(&g_recorder.file, __ATOMIC_RELAXED)) {
+
+        return;
+    }
+    size = event->size > sizeof(struct nevent) ?
+        event->size - sizeof(struct nevent) : 0u;
+    pthread_mutex_lock(&g_recorder.lock);
+
+    if (g_recorder.file) {
+        idx = recorder_epa_index(epa);
+
+        if (idx != CONFIG_ETRACE_EPAS) {
+            now = etrace_now();
+            putc_unlocked(ETRACE_TAG_EVENT, g_recorder.file);
+            put_varint(g_recorder.file, idx);
+            put_varint(g_recorder.file, now - g_recorder.last_ns);
+            put_varint(g_recorder.file, event->id);
+            put_varint(g_recorder.file, size);
+            fwrite(event + 1, 1u, size, g_recorder.file);
+            g_recorder.last_ns = now;
+        }
+    }
+    pthread_mutex_unlock(&g_recorder.lock);
+}
+
+
+
+nerror netrace_replay_open(struct netrace_replay * replay, const char * path,
+        struct nepa * const * epas, size_t n_epas)
+{
+    char                        magic[sizeof(ETRACE_MAGIC)];
+
+    NREQUIRE(replay);
+    NREQUIRE(path);
+    NREQUIRE(epas || !n_epas);
+
+    replay->file = fopen(path, "rb");
+
+    if (!replay->file) {
+
+        return (NERROR_OBJECT_NFOUND);
+    }
+
+    if ((fread(magic, 1u, sizeof(magic), replay->file) != sizeof(magic)) ||
+        memcmp(magic, ETRACE_MAGIC, sizeof(ETRACE_MAGIC) - 1u) ||
+        ((uint8_t)magic[sizeof(magic) - 1u] != ETRACE_VERSION)) {
+        fclose(replay->file);
+        replay->file = NULL;
+
+        return (NERROR_OBJECT_INVALID);
+    }
+    replay->epas    = epas;
+    replay->n_epas  = n_epas;
+    replay->dropped = 0u;
+    memset(replay->map, 0, sizeof(replay->map));
+
+    return (NERROR_NONE);
+}
+
+
+
+nerror netrace_replay_run(struct netrace_replay * replay,
+        enum netrace_pace pace)
+{
+    struct timespec             deadline;
+    nerror                      error;
+    int                         tag;
+
+    NREQUIRE(replay && replay->file);
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    error = NERROR_NONE;
+
+    while ((error == NERROR_NONE) &&
+           ((tag = getc_unlocked(replay->file)) != EOF)) {
+
+        switch (tag) {
+            case ETRACE_TAG_EPA:
+                error = replay_define_epa(replay);
+                break;
+            case ETRACE_TAG_EVENT:
+                error = replay_event(replay, pace, &deadline);
+                break;
+            default:
+                error = NERROR_OBJECT_INVALID;
+                break;
+        }
+    }
+
+    return (error);
+}
+
+
+
+void netrace_replay_close(struct netrace_replay * replay)
+{
+    NREQUIRE(replay && replay->file);
+
+    fclose(replay->file);
+    replay->file = NULL;
+}
+
+#endif /* (CONFIG_ETRACE == 1) */
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of etrace.c
+ ******************************************************************************/
@@ -30,6 +30,7 @@
 
 /*=========================================================  INCLUDE FILES  ==*/
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -41,9 +42,33 @@
 /*=========================================================  LOCAL MACRO's  ==*/
 /*======================================================  LOCAL DATA TYPES  ==*/
 
+#if (CONFIG_EVENT_RESERVE == 1)
+/**@brief       Reserve of a memory object used for event storage
+ */
+struct event_reserve
+{
+    struct nmem *               mem;
+    size_t                      watermark;
+    uint_fast8_t                min_priority;
+};
+#endif
+
 struct event_storage
 {
     struct nmem *               mem[CONFIG_EVENT_STORAGE_NPOOLS];
+#if (CONFIG_EVENT_COMPACT == 1)
+    /* NOTE:
+     * The mem array is kept sorted by block size, so the index of a memory
+     * object changes during registration. Compact events reference their
+     * memory object through this table where indexes are stable.
+     */
+    struct nmem *               table[CONFIG_EVENT_STORAGE_NPOOLS];
+                                        /* Live events of table entries      */
+    uint32_t                    live[CONFIG_EVENT_STORAGE_NPOOLS];
+#endif
+#if (CONFIG_EVENT_RESERVE == 1)
+    struct event_reserve        reserve[CONFIG_EVENT_STORAGE_NPOOLS];
+#endif
     uint_fast8_t                pools;
 };
 
@@ -70,6 +95,50 @@ static void event_term(struct nevent * event);
 
 static struct nmem * find_memory_i(size_t size);
 
+/**
+ * @brief       Get memory object which was used to allocate the event
+ * @param       event
+ *              Event
+ * @return      Pointer to memory object or NULL if the event is static
+ */
+static struct nmem * event_mem(const struct nevent * event);
+
+/**
+ * @brief       Allocate event storage
+ * @param       reserved
+ *              When true the allocation may use the reserve of memory object
+ */
+static void * event_alloc_i(struct nmem * mem, size_t size, bool reserved);
+
+/**
+ * @brief       Is a producer without reserve refused by the memory reserve?
+ * @details     I-class creators use this to tell a refusal from an exhausted
+ *              memory.
+ */
+static bool reserve_denies_i(struct nmem * mem, size_t size);
+
+/**
+ * @brief       Allocate event storage without checking the reserve
+ */
+static void * storage_alloc_i(struct nmem * mem, size_t size);
+
+/**
+ * @brief       Return event storage
+ */
+static void storage_free_i(struct nmem * mem, void * storage);
+
+#if (CONFIG_EVENT_COMPACT == 1)
+/**
+ * @brief       Get table index of registered memory object
+ * @return      Index or @ref NEVENT_MEM_NONE if memory is not registered
+ */
+static uint_fast8_t storage_index(const struct nmem * mem);
+#endif
+
+#if (CONFIG_EVENT_RESERVE == 1)
+static struct event_reserve * find_reserve(const struct nmem * mem);
+#endif
+
 /*=======================================================  LOCAL VARIABLES  ==*/
 
 static struct event_storage     g_event_storage;
@@ -77,7 +146,7 @@ static struct event_storage     g_event_storage;
 /*======================================================  GLOBAL VARIABLES  ==*/
 
 const struct nevent             g_default_event = 
-        NEVENT_INITIALIZER(UINT_FAST16_MAX, NULL, sizeof(struct nevent));
+        NEVENT_INITIALIZER(UINT16_MAX, NULL, sizeof(struct nevent));
 
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
 
@@ -89,9 +158,22 @@ static void event_init(struct nevent * event, uint16_t id, struct nmem * mem,
      */
 
     event->id       = id;
+#if (CONFIG_EVENT_COMPACT == 1)
+    event->ref      = 0u;
+#else
     ncore_atomic_write(&event->ref, 0);
+#endif
     event->attrib   = NEVENT_ATTR_DYNAMIC;
+#if (CONFIG_EVENT_COMPACT == 1)
+    /* NOTE:
+     * Storage is allocated only from registered memory objects and the memory
+     * object can not be unregistered while it holds live events.
+     */
+    event->mem      = (uint8_t)storage_index(mem);
+    NENSURE(event->mem != NEVENT_MEM_NONE);
+#else
     event->mem      = mem;
+#endif
 #if (CONFIG_EVENT_PRODUCER == 1)
     event->producer = nepa_get_current();
 #endif
@@ -139,6 +221,110 @@ static struct nmem * find_memory_i(size_t size)
 #endif
 }
 
+static struct nmem * event_mem(const struct nevent * event)
+{
+#if (CONFIG_EVENT_COMPACT == 1)
+    if (event->mem == NEVENT_MEM_NONE) {
+
+        return (NULL);
+    }
+
+    return (g_event_storage.table[event->mem]);
+#else
+    return (event->mem);
+#endif
+}
+
+static void * event_alloc_i(struct nmem * mem, size_t size, bool reserved)
+{
+    if ((reserved == false) && reserve_denies_i(mem, size)) {
+
+        return (NULL);
+    }
+
+    return (storage_alloc_i(mem, size));
+}
+
+static bool reserve_denies_i(struct nmem * mem, size_t size)
+{
+#if (CONFIG_EVENT_RESERVE == 1)
+    const struct event_reserve * reserve;
+
+    reserve = find_reserve(mem);
+
+    /* NOTE:
+     * Priority of the producer is checked only when the memory is about to
+     * drop below its watermark. Free bytes are not valid until the memory
+     * object makes its first allocation.
+     */
+    return ((reserve != NULL) && (mem->vf_free != NULL) &&
+        (nmem_get_free(mem) < reserve->watermark + size) &&
+        (nthread_get_current_priority() < reserve->min_priority));
+#else
+    (void)mem;
+    (void)size;
+
+    return (false);
+#endif
+}
+
+static void * storage_alloc_i(struct nmem * mem, size_t size)
+{
+    void *                      storage;
+
+    storage = nmem_alloc_i(mem, size);
+#if (CONFIG_EVENT_COMPACT == 1)
+
+    if (storage) {
+        g_event_storage.live[storage_index(mem)]++;
+    }
+#endif
+
+    return (storage);
+}
+
+static void storage_free_i(struct nmem * mem, void * storage)
+{
+#if (CONFIG_EVENT_COMPACT == 1)
+    g_event_storage.live[storage_index(mem)]--;
+#endif
+    nmem_free_i(mem, storage);
+}
+
+#if (CONFIG_EVENT_COMPACT == 1)
+static uint_fast8_t storage_index(const struct nmem * mem)
+{
+    uint_fast8_t                idx;
+
+    for (idx = 0u; idx < CONFIG_EVENT_STORAGE_NPOOLS; idx++) {
+
+        if (g_event_storage.table[idx] == mem) {
+
+            return (idx);
+        }
+    }
+
+    return (NEVENT_MEM_NONE);
+}
+#endif
+
+#if (CONFIG_EVENT_RESERVE == 1)
+static struct event_reserve * find_reserve(const struct nmem * mem)
+{
+    uint_fast8_t                cnt;
+
+    for (cnt = 0u; cnt < CONFIG_EVENT_STORAGE_NPOOLS; cnt++) {
+
+        if (g_event_storage.reserve[cnt].mem == mem) {
+
+            return (&g_event_storage.reserve[cnt]);
+        }
+    }
+
+    return (NULL);
+}
+#endif
+
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
 
 
@@ -164,12 +350,20 @@ void nevent_register_mem(struct nmem * mem)
     }
     g_event_storage.mem[cnt] = mem;
     g_event_storage.pools++;
+#if (CONFIG_EVENT_COMPACT == 1)
+    cnt = 0u;
+
+    while (g_event_storage.table[cnt] != NULL) {
+        cnt++;
+    }
+    g_event_storage.table[cnt] = mem;
+#endif
     ncore_lock_exit(&sys_lock);
 }
 
 
 
-void nevent_unregister_mem(struct nmem * mem)
+nerror nevent_unregister_mem(struct nmem * mem)
 {
     ncore_lock                  sys_lock;
     uint_fast8_t                cnt;
@@ -178,12 +372,23 @@ void nevent_unregister_mem(struct nmem * mem)
     NREQUIRE(g_event_storage.pools != 0);
 
     ncore_lock_enter(&sys_lock);
-    cnt = g_event_storage.pools;
+#if (CONFIG_EVENT_COMPACT == 1)
+                                        /* Live events reference the memory  */
+                                        /* by its table index.               */
+    cnt = storage_index(mem);
 
-    while ((0u < cnt) && (mem != g_event_storage.mem[cnt])) {
-        cnt--;
+    if ((cnt != NEVENT_MEM_NONE) && (g_event_storage.live[cnt] != 0u)) {
+        ncore_lock_exit(&sys_lock);
+
+        return (NERROR_NOT_PERMITTED);
+    }
+#endif
+    cnt = 0u;
+
+    while ((cnt < g_event_storage.pools) && (mem != g_event_storage.mem[cnt])) {
+        cnt++;
     }
-    NENSURE(mem == g_event_storage.mem[cnt]);
+    NENSURE(cnt < g_event_storage.pools);
 
     g_event_storage.pools--;
 
@@ -191,9 +396,55 @@ void nevent_unregister_mem(struct nmem * mem)
         g_event_storage.mem[cnt] = g_event_storage.mem[cnt + 1];
         cnt++;
     }
-    g_event_storage.mem[g_event_storage.pools - 1] = NULL;
+    g_event_storage.mem[g_event_storage.pools] = NULL;
+#if (CONFIG_EVENT_COMPACT == 1)
+
+    for (cnt = 0u; cnt < CONFIG_EVENT_STORAGE_NPOOLS; cnt++) {
+
+        if (g_event_storage.table[cnt] == mem) {
+            g_event_storage.table[cnt] = NULL;
+        }
+    }
+#endif
+#if (CONFIG_EVENT_RESERVE == 1)
+    {
+        struct event_reserve *  reserve = find_reserve(mem);
+
+        if (reserve) {
+            reserve->mem = NULL;
+        }
+    }
+#endif
+    ncore_lock_exit(&sys_lock);
+
+    return (NERROR_NONE);
+}
+
+
+
+#if (CONFIG_EVENT_RESERVE == 1)
+void nevent_set_reserve(struct nmem * mem, size_t watermark,
+        uint8_t min_priority)
+{
+    ncore_lock                  sys_lock;
+    struct event_reserve *      reserve;
+
+    NREQUIRE(N_IS_MEM_OBJECT(mem));
+
+    ncore_lock_enter(&sys_lock);
+    reserve = find_reserve(mem);
+
+    if (reserve == NULL) {
+        reserve = find_reserve(NULL);
+    }
+    NENSURE(reserve);
+
+    reserve->mem          = watermark != 0u ? mem : NULL;
+    reserve->watermark    = watermark;
+    reserve->min_priority = min_priority;
     ncore_lock_exit(&sys_lock);
 }
+#endif
 
 
 
@@ -205,7 +456,7 @@ struct nevent * nevent_create(size_t size, uint16_t id)
 
     ncore_lock_enter(&sys_lock);
     mem   = find_memory_i(size);
-    event = nmem_alloc_i(mem, size);
+    event = event_alloc_i(mem, size, false);
     ncore_lock_exit(&sys_lock);
 
     if (event) {
@@ -225,8 +476,49 @@ struct nevent * nevent_create_i(size_t size, uint16_t id)
     NREQUIRE(ncore_is_lock_valid());
 
     mem   = find_memory_i(size);
-    event = nmem_alloc_i(mem, size);
+    event = event_alloc_i(mem, size, false);
     
+    if (event) {
+        event_init(event, id, mem, size);
+    }
+    NENSURE(event || reserve_denies_i(mem, size));
+
+    return (event);
+}
+
+
+
+#if (CONFIG_EVENT_RESERVE == 1)
+struct nevent * nevent_create_reserved(size_t size, uint16_t id)
+{
+    struct nmem *               mem;
+    struct nevent *             event;
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    mem   = find_memory_i(size);
+    event = event_alloc_i(mem, size, true);
+    ncore_lock_exit(&sys_lock);
+
+    if (event) {
+        event_init(event, id, mem, size);
+    }
+
+    return (event);
+}
+
+
+
+struct nevent * nevent_create_reserved_i(size_t size, uint16_t id)
+{
+    struct nmem *               mem;
+    struct nevent *             event;
+
+    NREQUIRE(ncore_is_lock_valid());
+
+    mem   = find_memory_i(size);
+    event = event_alloc_i(mem, size, true);
+
     if (event) {
         event_init(event, id, mem, size);
     }
@@ -237,6 +529,66 @@ struct nevent * nevent_create_i(size_t size, uint16_t id)
 
 
 
+nerror nevent_reserve_i(struct nevent_reservation * reservation, size_t size)
+{
+    NREQUIRE(reservation);
+    NREQUIRE(size >= sizeof(struct nevent));
+    NREQUIRE(ncore_is_lock_valid());
+
+    reservation->mem     = find_memory_i(size);
+    reservation->storage = event_alloc_i(reservation->mem, size, true);
+    reservation->size    = size;
+
+    return (reservation->storage != NULL ? NERROR_NONE : NERROR_NO_MEMORY);
+}
+
+
+
+nerror nevent_reserve(struct nevent_reservation * reservation, size_t size)
+{
+    ncore_lock                  sys_lock;
+    nerror                      error;
+
+    ncore_lock_enter(&sys_lock);
+    error = nevent_reserve_i(reservation, size);
+    ncore_lock_exit(&sys_lock);
+
+    return (error);
+}
+
+
+
+struct nevent * nevent_commit(struct nevent_reservation * reservation,
+        uint16_t id)
+{
+    struct nevent *             event;
+
+    NREQUIRE(reservation && reservation->storage);
+
+    event                = reservation->storage;
+    reservation->storage = NULL;
+    event_init(event, id, reservation->mem, reservation->size);
+
+    return (event);
+}
+
+
+
+void nevent_cancel(struct nevent_reservation * reservation)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(reservation && reservation->storage);
+
+    ncore_lock_enter(&sys_lock);
+    storage_free_i(reservation->mem, reservation->storage);
+    ncore_lock_exit(&sys_lock);
+    reservation->storage = NULL;
+}
+#endif
+
+
+
 struct nevent * nevent_create_from_i(struct nmem * mem, size_t size, 
 	uint16_t id)
 {
@@ -245,7 +597,14 @@ struct nevent * nevent_create_from_i(struct nmem * mem, size_t size,
     NREQUIRE(size >= sizeof(struct nevent));
     NREQUIRE(ncore_is_lock_valid());
 
-    event = nmem_alloc_i(mem, size);
+#if (CONFIG_EVENT_COMPACT == 1)
+    if (storage_index(mem) == NEVENT_MEM_NONE) {
+                                        /* Compact events can be allocated    */
+                                        /* only from registered memory.       */
+        return (NULL);
+    }
+#endif
+    event = storage_alloc_i(mem, size);
 
     if (event) {
         event_init(event, id, mem, size);
@@ -274,7 +633,7 @@ void nevent_destroy_i(const struct nevent * event)
 
     if (nevent_ref(event) == 0u) {
         event_term((struct nevent *)event);
-        nmem_free_i(event->mem, (void *)event);
+        storage_free_i(event_mem(event), (void *)event);
     }
 }
 
@@ -286,24 +645,27 @@ struct nevent * nevent_forward(const struct nevent * event, uint16_t id)
     ncore_lock                  lock;
     struct nmem *               mem;
     struct nevent *             ret;
+    bool                        is_denied;
 
     NREQUIRE(N_IS_EVENT_OBJECT(event));
 
     ncore_lock_enter(&lock);
 
-    if (event->mem) {
-        mem = event->mem;
-    } else {
+    mem = event_mem(event);
+
+    if (!mem) {
         mem = find_memory_i(event->size);
     }
-    ret = nmem_alloc_i(mem, event->size);
+    ret       = event_alloc_i(mem, event->size, false);
+    is_denied = (ret == NULL) && reserve_denies_i(mem, event->size);
     ncore_lock_exit(&lock);
 
     if (ret) {
         memcpy(ret, event, event->size);
-        event_init(ret, id, event->mem, event->size);
+        event_init(ret, id, mem, event->size);
     }
-    NENSURE(ret);
+    NENSURE(ret || is_denied);
+    (void)is_denied;
 
     return (ret);
 #else
@@ -321,6 +683,35 @@ struct nevent * nevent_forward(const struct nevent * event, uint16_t id)
 
 
 
+struct nevent * nevent_recycle(const struct nevent * event, uint16_t id)
+{
+    NREQUIRE(N_IS_EVENT_OBJECT(event));
+
+    /* NOTE:
+     * When the caller is the only holder of a dynamic event nobody else can
+     * raise the reference count, so no lock is needed to take over the event.
+     * Constant and reserved events are never taken over.
+     */
+    if ((event->attrib == NEVENT_ATTR_DYNAMIC) &&
+        (np_event_ref_count(event) == 1)) {
+        /* NOTE:
+         * Cast away const qualifier, the event is owned by the caller.
+         */
+        struct nevent *         ret = (struct nevent *)event;
+
+        ret->id       = id;
+#if (CONFIG_EVENT_PRODUCER == 1)
+        ret->producer = nepa_get_current();
+#endif
+
+        return (ret);
+    }
+
+    return (nevent_forward(event, id));
+}
+
+
+
 void nevent_lock(const struct nevent * event)
 {
     NREQUIRE(N_IS_EVENT_OBJECT(event));
@@ -341,12 +732,12 @@ void nevent_unlock(const struct nevent * event)
 
         event_->attrib = NEVENT_ATTR_DYNAMIC;
 
-        if (ncore_atomic_read(&event_->ref) == 0u) {
+        if (np_event_ref_count(event_) == 0u) {
             struct ncore_lock    sys_lock;
 
             event_term(event_);
             ncore_lock_enter(&sys_lock);
-            nmem_free_i(event_->mem, event_);
+            storage_free_i(event_mem(event_), event_);
             ncore_lock_exit(&sys_lock);
         }
     }
@@ -30,12 +30,24 @@
 
 /*=========================================================  INCLUDE FILES  ==*/
 
+#include <string.h>
+
 #include "port/core.h"
 #include "base/debug.h"
 #include "base/bitop.h"
 #include "mm/heap.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
+
+#define BLOCK_FROM_MEM(mem)                                                     \
+    ((struct heap_block *)((uint8_t *)(mem) - offsetof(struct heap_block, free)))
+
+/**@brief       Physically next block of an allocated block
+ */
+#define BLOCK_PHY_NEXT(block)                                                   \
+    ((struct heap_block *)((uint8_t *)(block) - (block)->phy.size +             \
+        sizeof(struct heap_phy [1])))
+
 /*======================================================  LOCAL DATA TYPES  ==*/
 
 /**@brief       Dynamic allocator memory block header structure
@@ -60,6 +72,23 @@ static void * heap_alloc(struct nmem * heap_obj, size_t size);
 
 static void heap_free(struct nmem * heap_obj, void * mem);
 
+static void * heap_alloc_aligned(struct nmem * heap_obj, size_t size,
+        size_t align);
+
+static void * heap_realloc(struct nmem * heap_obj, void * mem,
+        size_t old_size, size_t new_size);
+
+static void heap_free_sized(struct nmem * heap_obj, void * mem, size_t size);
+
+/**@brief       Split the end of allocated block into a new free block
+ */
+static void heap_trim(struct nmem * heap_obj, struct heap_block * block,
+        size_t size);
+
+#if (CONFIG_MEM_STATS == 1)
+static size_t heap_largest(struct nmem * heap_obj);
+#endif
+
 /*=======================================================  LOCAL VARIABLES  ==*/
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
@@ -108,6 +137,7 @@ static void * heap_alloc(struct nmem * heap_obj, size_t size)
                      sizeof(struct heap_phy [1]));
                                        /* Point to the newly created block    */
                 curr->phy.prev = tmp;
+                heap_obj->free -= size + sizeof(struct heap_phy [1]);
 
                 break;
             } else {
@@ -117,6 +147,7 @@ static void * heap_alloc(struct nmem * heap_obj, size_t size)
                 curr->free.next->free.prev = curr->free.prev;
                 curr->free.prev->free.next = curr->free.next;
                 curr->phy.size             = curr->phy.size * (-1);
+                heap_obj->free            -= (size_t)-curr->phy.size;
 
                 break;
             }
@@ -140,6 +171,7 @@ static void heap_free(struct nmem * heap_obj, void * mem)
     curr           = (struct heap_block *)
         ((uint8_t *)mem - offsetof(struct heap_block, free));
     curr->phy.size = (int32_t)curr->phy.size * (-1); /* Mark block as free */
+    heap_obj->free += (size_t)curr->phy.size;
     tmp            = (struct heap_block *)
         ((uint8_t *)curr + curr->phy.size + sizeof(struct heap_phy [1]));
 
@@ -148,6 +180,7 @@ static void heap_free(struct nmem * heap_obj, void * mem)
         curr->phy.prev->phy.size  += curr->phy.size;
         curr->phy.prev->phy.size  += (int32_t)sizeof(struct heap_phy [1]);
         tmp->phy.prev              = curr->phy.prev;
+        heap_obj->free            += sizeof(struct heap_phy [1]);
                                                         /* Next block is free */
     } else if ((curr->phy.prev->phy.size < 0) && (tmp->phy.size > 0)) {         
         curr->free.next            = tmp->free.next;
@@ -159,6 +192,7 @@ static void heap_free(struct nmem * heap_obj, void * mem)
         tmp                        = (struct heap_block *)
             ((uint8_t *)curr + curr->phy.size + sizeof(struct heap_phy [1]));
         tmp->phy.prev              = curr;
+        heap_obj->free            += sizeof(struct heap_phy [1]);
                                          /* Previous and next blocks are free */
     } else if ((curr->phy.prev->phy.size > 0) && (tmp->phy.size > 0)) {         
         tmp->free.prev->free.next  = tmp->free.next;
@@ -169,6 +203,7 @@ static void heap_free(struct nmem * heap_obj, void * mem)
             ((uint8_t *)curr->phy.prev + curr->phy.prev->phy.size +
             sizeof(struct heap_phy [1]));
         tmp->phy.prev              = curr->phy.prev;
+        heap_obj->free            += sizeof(struct heap_phy [2]);
                                       /* Previous and next blocks are used    */
     } else {                                                                    
         struct heap_block *     sentinel = heap_obj->base;
@@ -180,6 +215,148 @@ static void heap_free(struct nmem * heap_obj, void * mem)
     }
 }
 
+static void * heap_alloc_aligned(struct nmem * heap_obj, size_t size,
+        size_t align)
+{
+    struct heap_block *         curr;
+    struct heap_block *         block;
+    struct heap_block *         next;
+    uint8_t *                   mem;
+
+    NREQUIRE(NSIGNATURE_OF(heap_obj) == NSIGNATURE_HEAP);
+    NREQUIRE((size != 0u) && (size < INT32_MAX));
+
+    if (align <= NCPU_DATA_ALIGNMENT) {
+
+        return (heap_alloc(heap_obj, size));
+    }
+    mem = heap_alloc(heap_obj, size + align + sizeof(struct heap_block [1]));
+
+    if (mem == NULL) {
+
+        return (NULL);
+    }
+
+    if (((uintptr_t)mem & (align - 1u)) == 0u) {
+        heap_trim(heap_obj, BLOCK_FROM_MEM(mem), size);
+
+        return (mem);
+    }
+
+    /* NOTE:
+     * The block is large enough to move the aligned payload at least one
+     * block header away, so the space in front of it becomes a free block.
+     */
+    curr  = BLOCK_FROM_MEM(mem);
+    next  = BLOCK_PHY_NEXT(curr);
+    block = BLOCK_FROM_MEM(NALIGN_UP((uintptr_t)mem +
+        sizeof(struct heap_block [1]), (uintptr_t)align));
+    block->phy.prev = curr;
+    block->phy.size = -(int32_t)((uint8_t *)next - (uint8_t *)block -
+        sizeof(struct heap_phy [1]));
+    next->phy.prev  = block;
+    curr->phy.size  = -(int32_t)((uint8_t *)block - (uint8_t *)curr -
+        sizeof(struct heap_phy [1]));
+    heap_free(heap_obj, mem);
+    heap_trim(heap_obj, block, size);
+
+    return ((void *)&block->free);
+}
+
+static void * heap_realloc(struct nmem * heap_obj, void * mem,
+        size_t old_size, size_t new_size)
+{
+    struct heap_block *         curr;
+    struct heap_block *         next;
+    void *                      new_mem;
+
+    NREQUIRE(NSIGNATURE_OF(heap_obj) == NSIGNATURE_HEAP);
+    NREQUIRE(mem);
+    NREQUIRE((new_size != 0u) && (new_size < INT32_MAX));
+    NREQUIRE(ncore_is_lock_valid());
+
+    curr = BLOCK_FROM_MEM(mem);
+    next = BLOCK_PHY_NEXT(curr);
+
+    if ((size_t)-curr->phy.size < new_size) {
+
+        if ((next->phy.size > 0) &&
+            ((size_t)(-curr->phy.size + next->phy.size) +
+             sizeof(struct heap_phy [1]) >= new_size)) {
+                                        /* Take the next free block over      */
+            next->free.next->free.prev = next->free.prev;
+            next->free.prev->free.next = next->free.next;
+            heap_obj->free            -= (size_t)next->phy.size;
+            curr->phy.size            -= next->phy.size;
+            curr->phy.size            -= (int32_t)sizeof(struct heap_phy [1]);
+            BLOCK_PHY_NEXT(curr)->phy.prev = curr;
+        } else {
+            new_mem = heap_alloc(heap_obj, new_size);
+
+            if (new_mem) {
+                memcpy(new_mem, mem, old_size < new_size ? old_size : new_size);
+                heap_free(heap_obj, mem);
+            }
+
+            return (new_mem);
+        }
+    }
+    heap_trim(heap_obj, curr, new_size);
+
+    return (mem);
+}
+
+static void heap_free_sized(struct nmem * heap_obj, void * mem, size_t size)
+{
+    NREQUIRE(mem);
+    NREQUIRE(size <= (size_t)-BLOCK_FROM_MEM(mem)->phy.size);
+
+    (void)size;
+    heap_free(heap_obj, mem);
+}
+
+static void heap_trim(struct nmem * heap_obj, struct heap_block * block,
+        size_t size)
+{
+    struct heap_block *         tail;
+    size_t                      block_size;
+
+    size       = NALIGN_UP(size, sizeof(struct heap_phy [1]));
+    block_size = (size_t)-block->phy.size;
+
+    if (block_size > size + sizeof(struct heap_block [1])) {
+        tail           = (struct heap_block *)
+            ((uint8_t *)&block->free + size);
+        tail->phy.prev = block;
+        tail->phy.size = -(int32_t)(block_size - size -
+            sizeof(struct heap_phy [1]));
+        BLOCK_PHY_NEXT(tail)->phy.prev = tail;
+        block->phy.size = -(int32_t)size;
+        heap_free(heap_obj, &tail->free);
+    }
+}
+
+#if (CONFIG_MEM_STATS == 1)
+static size_t heap_largest(struct nmem * heap_obj)
+{
+    struct heap_block *         sentinel;
+    struct heap_block *         curr;
+    size_t                      largest;
+
+    largest  = 0u;
+    sentinel = heap_obj->base;
+
+    for (curr = sentinel->free.next; curr != sentinel; curr = curr->free.next) {
+
+        if ((size_t)curr->phy.size > largest) {
+            largest = (size_t)curr->phy.size;
+        }
+    }
+
+    return (largest);
+}
+#endif
+
 /*===================================  GLOBAL PRIVATE FUNCTION DEFINITIONS  ==*/
 /*====================================  GLOBAL PUBLIC FUNCTION DEFINITIONS  ==*/
 
@@ -213,10 +390,26 @@ void * heap_init_alloc(struct nmem * heap_obj, size_t size)
     heap_obj->free = (size_t)begin->phy.size;
     heap_obj->vf_alloc = heap_alloc;
     heap_obj->vf_free  = heap_free;
+    heap_obj->vf_alloc_aligned = heap_alloc_aligned;
+    heap_obj->vf_realloc       = heap_realloc;
+    heap_obj->vf_free_sized    = heap_free_sized;
+#if (CONFIG_MEM_STATS == 1)
+    heap_obj->vf_largest = heap_largest;
+#endif
 
     return (heap_alloc(heap_obj, size));
 }
 
+void nheap_init(struct nmem * heap_obj, void * storage, size_t size)
+{
+    NREQUIRE(heap_obj);
+    NREQUIRE(NSIGNATURE_OF(heap_obj) != NSIGNATURE_HEAP);
+
+    n_mem_init(heap_obj, heap_init_alloc, storage, size, 1u);
+
+    NOBLIGATION(NSIGNATURE_IS(heap_obj, NSIGNATURE_HEAP));
+}
+
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 /** @endcond *//** @} *//** @} *//*********************************************
  * END of heap_mem.c
@@ -0,0 +1,537 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       High resolution timer implementation
+ * @addtogroup  timer_hrtimer
+ *********************************************************************//** @{ */
+/**@defgroup    timer_hrtimer_impl Implementation
+ * @brief       High resolution timer implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#define _GNU_SOURCE
+
+#include "base/config.h"
+
+#if (CONFIG_HRTIMER == 1)
+#include <time.h>
+#include <pthread.h>
+
+#include "port/core.h"
+#include "base/debug.h"
+#include "timer/hrtimer.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define HEAP_PARENT(idx)                (((idx) - 1u) / 2u)
+
+#define HEAP_LEFT(idx)                  ((idx) * 2u + 1u)
+
+/**@brief       Latest time when the timer must expire
+ */
+#define HARD_DEADLINE(timer)            ((timer)->deadline + (timer)->slack)
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/**@brief       Running timers ordered by hard deadline
+ * @details     Binary min-heap, the earliest hard deadline is always at index
+ *              0. Each timer remembers its heap position so it can be
+ *              cancelled without searching.
+ *
+ *              The heap is protected by the core lock. The service thread
+ *              sleeps on its own mutex and condition variable, @c kick is
+ *              changed under that mutex every time the thread must re-read
+ *              the heap. When both locks are needed the core lock is always
+ *              taken first.
+ */
+struct hrtimer_queue
+{
+    pthread_mutex_t             mutex;
+    pthread_cond_t              wakeup;
+    pthread_t                   thread;
+    bool                        is_started;
+    bool                        is_stopping;
+    uint32_t                    kick;   /**<@brief Wakeup request counter */
+    uint32_t                    n_timers;
+    uint32_t                    saved;  /**<@brief Wakeups saved by slack */
+    struct nhrtimer *           heap[CONFIG_HRTIMER_MAX];
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static void heap_place(uint32_t idx, struct nhrtimer * timer);
+
+static void heap_up(uint32_t idx);
+
+static void heap_down(uint32_t idx);
+
+static void heap_remove(struct nhrtimer * timer);
+
+static void hrtimer_kick_i(void);
+
+static nerror hrtimer_setup_i(void);
+
+static void hrtimer_wait_i(const struct timespec * deadline);
+
+/**@brief       Service thread which executes the expired timers
+ */
+static void * hrtimer_thread(void * arg);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static struct hrtimer_queue     g_hrtimer =
+{
+    .mutex    = PTHREAD_MUTEX_INITIALIZER,
+    .n_timers = 0u
+};
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static void heap_place(uint32_t idx, struct nhrtimer * timer)
+{
+    g_hrtimer.heap[idx] = timer;
+    timer->index        = idx + 1u;
+}
+
+
+
+static void heap_up(uint32_t idx)
+{
+    struct nhrtimer *           timer = g_hrtimer.heap[idx];
+
+    while (idx != 0u) {
+        struct nhrtimer *       parent = g_hrtimer.heap[HEAP_PARENT(idx)];
+
+        if (HARD_DEADLINE(parent) <= HARD_DEADLINE(timer)) {
+            break;
+        }
+        heap_place(idx, parent);
+        idx = HEAP_PARENT(idx);
+    }
+    heap_place(idx, timer);
+}
+
+
+
+static void heap_down(uint32_t idx)
+{
+    struct nhrtimer *           timer = g_hrtimer.heap[idx];
+
+    for (;;) {
+        uint32_t                child = HEAP_LEFT(idx);
+
+        if (child >= g_hrtimer.n_timers) {
+            break;
+        }
+
+        if ((child + 1u < g_hrtimer.n_timers) &&
+            (HARD_DEADLINE(g_hrtimer.heap[child + 1u]) <
+             HARD_DEADLINE(g_hrtimer.heap[child]))) {
+            child++;
+        }
+
+        if (HARD_DEADLINE(timer) <= HARD_DEADLINE(g_hrtimer.heap[child])) {
+            break;
+        }
+        heap_place(idx, g_hrtimer.heap[child]);
+        idx = child;
+    }
+    heap_place(idx, timer);
+}
+
+
+
+static void heap_remove(struct nhrtimer * timer)
+{
+    uint32_t                    idx  = timer->index - 1u;
+    struct nhrtimer *           last;
+
+    timer->index = 0u;
+    last         = g_hrtimer.heap[--g_hrtimer.n_timers];
+
+    if (last != timer) {
+        heap_place(idx, last);
+
+        if ((idx != 0u) &&
+            (HARD_DEADLINE(last) <
+             HARD_DEADLINE(g_hrtimer.heap[HEAP_PARENT(idx)]))) {
+            heap_up(idx);
+        } else {
+            heap_down(idx);
+        }
+    }
+}
+
+
+
+/**@brief       Make the service thread re-read the heap
+ * @note        Called with the core lock held.
+ */
+static void hrtimer_kick_i(void)
+{
+    pthread_mutex_lock(&g_hrtimer.mutex);
+    g_hrtimer.kick++;
+    pthread_cond_signal(&g_hrtimer.wakeup);
+    pthread_mutex_unlock(&g_hrtimer.mutex);
+}
+
+
+
+/**@brief       Start the service thread
+ * @note        Called with the core lock held.
+ */
+static nerror hrtimer_setup_i(void)
+{
+    pthread_condattr_t          attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    if (pthread_cond_init(&g_hrtimer.wakeup, &attr) != 0) {
+        pthread_condattr_destroy(&attr);
+
+        return (NERROR_NO_RESOURCE);
+    }
+    pthread_condattr_destroy(&attr);
+    g_hrtimer.is_stopping = false;
+
+    if (pthread_create(&g_hrtimer.thread, NULL, hrtimer_thread, NULL) != 0) {
+        pthread_cond_destroy(&g_hrtimer.wakeup);
+
+        return (NERROR_NO_RESOURCE);
+    }
+    g_hrtimer.is_started = true;
+
+    return (NERROR_NONE);
+}
+
+
+
+/**@brief       Release the core lock and sleep until kicked or deadline
+ * @param       deadline
+ *              Absolute CLOCK_MONOTONIC time, or NULL to sleep until kicked
+ * @note        Called with the core lock held, returns with core lock held.
+ */
+static void hrtimer_wait_i(const struct timespec * deadline)
+{
+    ncore_lock                  lock;
+    uint32_t                    kick;
+
+    /* NOTE:
+     * The thread mutex is taken before the core lock is released, so a timer
+     * started in between increments the kick counter only after the thread
+     * is already waiting for it and the wakeup is not lost.
+     */
+    pthread_mutex_lock(&g_hrtimer.mutex);
+    kick = g_hrtimer.kick;
+    ncore_lock_exit(&lock);
+
+    while ((kick == g_hrtimer.kick) && !g_hrtimer.is_stopping) {
+
+        if (deadline == NULL) {
+            pthread_cond_wait(&g_hrtimer.wakeup, &g_hrtimer.mutex);
+        } else if (pthread_cond_timedwait(&g_hrtimer.wakeup, &g_hrtimer.mutex,
+                    deadline) != 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_hrtimer.mutex);
+    ncore_lock_enter(&lock);
+}
+
+
+
+static void * hrtimer_thread(void * arg)
+{
+    ncore_lock                  lock;
+    uint32_t                    expired;
+
+    (void)arg;
+
+    /* NOTE:
+     * Timers are examined and executed with the core lock held, so timer
+     * callbacks are executed in the same context as core timer callbacks.
+     */
+    ncore_lock_enter(&lock);
+    expired = 0u;
+
+    while (!g_hrtimer.is_stopping) {
+        struct nhrtimer *       timer;
+        uint64_t                now;
+
+        if (g_hrtimer.n_timers == 0u) {
+            expired = 0u;
+            hrtimer_wait_i(NULL);
+
+            continue;
+        }
+        timer = g_hrtimer.heap[0];
+        now   = nhrtimer_now();
+
+        /* NOTE:
+         * The thread sleeps until the earliest hard deadline. Once awake it
+         * runs every timer whose soft deadline has passed, so timers with
+         * overlapping slack share a single wakeup.
+         */
+        if (timer->deadline > now) {
+            struct timespec     deadline;
+            uint64_t            hard = HARD_DEADLINE(timer);
+
+            deadline.tv_sec  = (time_t)(hard / 1000000000u);
+            deadline.tv_nsec = (long)(hard % 1000000000u);
+            expired          = 0u;
+            hrtimer_wait_i(&deadline);
+
+            continue;
+        }
+        heap_remove(timer);
+
+        if ((timer->slack != 0u) && (expired != 0u)) {
+            g_hrtimer.saved++;
+        }
+        expired++;
+
+        if (timer->period != 0u) {
+            uint64_t            missed;
+
+            /* NOTE:
+             * Next deadline is always a multiple of period away from the
+             * first one, whole periods which have already passed are skipped.
+             */
+            missed           = (now - timer->deadline) / timer->period;
+            timer->overrun  += (uint32_t)missed;
+            timer->deadline += (missed + 1u) * timer->period;
+            heap_place(g_hrtimer.n_timers++, timer);
+            heap_up(g_hrtimer.n_timers - 1u);
+        }
+        timer->fn(timer->arg);
+
+        /* NOTE:
+         * Let other threads take the lock between callbacks of a burst.
+         */
+        ncore_lock_exit(&lock);
+        ncore_lock_enter(&lock);
+    }
+    ncore_lock_exit(&lock);
+
+    return (NULL);
+}
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+void nhrtimer_init(struct nhrtimer * timer)
+{
+    NREQUIRE(NSIGNATURE_OF(timer) != NSIGNATURE_HRTIMER);
+
+    timer->index   = 0u;
+    timer->overrun = 0u;
+
+    NOBLIGATION(NSIGNATURE_IS(timer, NSIGNATURE_HRTIMER));
+}
+
+
+
+uint64_t nhrtimer_now(void)
+{
+    struct timespec             now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+}
+
+
+
+nerror nhrtimer_start_i(struct nhrtimer * timer, uint64_t deadline,
+        uint64_t slack, uint64_t period, void (* fn)(void *), void * arg)
+{
+    NREQUIRE(N_IS_HRTIMER_OBJECT(timer));
+    NREQUIRE(fn);
+    NREQUIRE(!nhrtimer_is_running_i(timer));
+    NREQUIRE(ncore_is_lock_valid());
+
+    if (g_hrtimer.n_timers == CONFIG_HRTIMER_MAX) {
+
+        return (NERROR_NO_RESOURCE);
+    }
+
+    if (!g_hrtimer.is_started) {
+        nerror                  error;
+
+        error = hrtimer_setup_i();
+
+        if (error != NERROR_NONE) {
+
+            return (error);
+        }
+    }
+    timer->deadline = deadline;
+    timer->slack    = slack;
+    timer->period   = period;
+    timer->fn       = fn;
+    timer->arg      = arg;
+    timer->overrun  = 0u;
+    heap_place(g_hrtimer.n_timers++, timer);
+    heap_up(g_hrtimer.n_timers - 1u);
+
+    if (timer->index == 1u) {
+        hrtimer_kick_i();
+    }
+
+    return (NERROR_NONE);
+}
+
+
+
+nerror nhrtimer_start(struct nhrtimer * timer, uint64_t deadline,
+        uint64_t slack, uint64_t period, void (* fn)(void *), void * arg)
+{
+    ncore_lock                  lock;
+    nerror                      error;
+
+    ncore_lock_enter(&lock);
+    error = nhrtimer_start_i(timer, deadline, slack, period, fn, arg);
+    ncore_lock_exit(&lock);
+
+    return (error);
+}
+
+
+
+void nhrtimer_cancel_i(struct nhrtimer * timer)
+{
+    NREQUIRE(N_IS_HRTIMER_OBJECT(timer));
+    NREQUIRE(ncore_is_lock_valid());
+
+    if (nhrtimer_is_running_i(timer)) {
+        heap_remove(timer);
+    }
+}
+
+
+
+void nhrtimer_cancel(struct nhrtimer * timer)
+{
+    ncore_lock                  lock;
+
+    ncore_lock_enter(&lock);
+    nhrtimer_cancel_i(timer);
+    ncore_lock_exit(&lock);
+}
+
+
+
+bool nhrtimer_is_running_i(const struct nhrtimer * timer)
+{
+    NREQUIRE(N_IS_HRTIMER_OBJECT(timer));
+
+    return (timer->index != 0u);
+}
+
+
+
+uint64_t nhrtimer_remaining(const struct nhrtimer * timer)
+{
+    ncore_lock                  lock;
+    uint64_t                    deadline;
+    uint64_t                    now;
+
+    NREQUIRE(N_IS_HRTIMER_OBJECT(timer));
+
+    ncore_lock_enter(&lock);
+    deadline = nhrtimer_is_running_i(timer) ? timer->deadline : 0u;
+    ncore_lock_exit(&lock);
+    now = nhrtimer_now();
+
+    return (deadline > now ? deadline - now : 0u);
+}
+
+
+
+uint32_t nhrtimer_overrun(const struct nhrtimer * timer)
+{
+    NREQUIRE(N_IS_HRTIMER_OBJECT(timer));
+
+    return (timer->overrun);
+}
+
+
+
+uint32_t nhrtimer_saved_wakeups(void)
+{
+    return (g_hrtimer.saved);
+}
+
+
+
+void nhrtimer_stop(void)
+{
+    ncore_lock                  lock;
+
+    /* NOTE:
+     * The service thread must take the core lock to exit, so the caller must
+     * not hold it, not even as an outer level of the recursive lock.
+     */
+    NREQUIRE(ncore_lock_depth() == 0u);
+
+    ncore_lock_enter(&lock);
+
+    if (!g_hrtimer.is_started) {
+        ncore_lock_exit(&lock);
+
+        return;
+    }
+    NREQUIRE(!pthread_equal(pthread_self(), g_hrtimer.thread));
+
+    while (g_hrtimer.n_timers != 0u) {
+        g_hrtimer.heap[--g_hrtimer.n_timers]->index = 0u;
+    }
+    pthread_mutex_lock(&g_hrtimer.mutex);
+    g_hrtimer.is_stopping = true;
+    pthread_cond_signal(&g_hrtimer.wakeup);
+    pthread_mutex_unlock(&g_hrtimer.mutex);
+    ncore_lock_exit(&lock);
+
+    /* NOTE:
+     * The thread needs the core lock to notice the stop request, so it is
+     * joined with the core lock released.
+     */
+    pthread_join(g_hrtimer.thread, NULL);
+
+    ncore_lock_enter(&lock);
+    pthread_cond_destroy(&g_hrtimer.wakeup);
+    g_hrtimer.is_started  = false;
+    g_hrtimer.is_stopping = false;
+    ncore_lock_exit(&lock);
+}
+
+#endif /* (CONFIG_HRTIMER == 1) */
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of hrtimer.c
+ ******************************************************************************/
@@ -0,0 +1,191 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Huge page memory implementation
+ * @addtogroup  mm_hugemem
+ *********************************************************************//** @{ */
+/**@defgroup    mm_hugemem_impl Implementation
+ * @brief       Huge page memory implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#define _GNU_SOURCE
+
+#include "base/config.h"
+
+#if (CONFIG_HUGEMEM == 1)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "port/core.h"
+#include "base/debug.h"
+#include "base/bitop.h"
+#include "mm/tlsf.h"
+#include "mm/hugemem.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+/**@brief       Memory policy of mbind() system call which allocates pages
+ *              only from the given nodes
+ */
+#define HUGEMEM_MPOL_BIND               2
+
+/**@brief       Maximum number of NUMA nodes
+ */
+#define HUGEMEM_MAX_NODES               1024u
+
+#define HUGEMEM_NODE_WORD_BITS          (sizeof(unsigned long) * 8u)
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static nerror hugemem_bind(void * region, size_t size, int node);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static nerror hugemem_bind(void * region, size_t size, int node)
+{
+    unsigned long               mask[HUGEMEM_MAX_NODES / HUGEMEM_NODE_WORD_BITS];
+    size_t                      word;
+
+    NREQUIRE((node >= 0) && ((unsigned)node < HUGEMEM_MAX_NODES));
+
+    for (word = 0u; word < NARRAY_DIMENSION(mask); word++) {
+        mask[word] = 0u;
+    }
+    mask[(unsigned)node / HUGEMEM_NODE_WORD_BITS] =
+        1ul << ((unsigned)node % HUGEMEM_NODE_WORD_BITS);
+
+    /* NOTE:
+     * The system call is used directly, so the library does not depend on
+     * libnuma. Pages are not touched yet, so they are all allocated on the
+     * node.
+     */
+    if (syscall(SYS_mbind, region, size, HUGEMEM_MPOL_BIND, mask,
+            (unsigned long)HUGEMEM_MAX_NODES, 0u) != 0) {
+
+        return (NERROR_ARG_INVALID);
+    }
+
+    return (NERROR_NONE);
+}
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+nerror nhugemem_init(struct nhugemem * huge_obj, size_t size, int node)
+{
+    void *                      region;
+
+    NREQUIRE(huge_obj);
+    NREQUIRE(size != 0u);
+
+    size = NALIGN_UP(size, (size_t)CONFIG_HUGEMEM_PAGE_SIZE);
+
+    /* NOTE:
+     * The whole region is managed by a single TLSF allocator, so it must be
+     * smaller than what TLSF can manage. Zero size means that rounding up
+     * has wrapped around.
+     */
+    if ((size == 0u) ||
+        (size >= ((size_t)1u << CONFIG_TLSF_MAX_SIZE_BITS))) {
+
+        return (NERROR_ARG_INVALID);
+    }
+
+    huge_obj->is_hugetlb = true;
+    region = mmap(NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    if (region == MAP_FAILED) {
+        /* NOTE:
+         * There are not enough pages reserved in the kernel huge page pool.
+         * Use normal pages and ask the kernel to back the region with
+         * transparent huge pages.
+         */
+        huge_obj->is_hugetlb = false;
+        region = mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (region == MAP_FAILED) {
+
+            return (NERROR_NO_MEMORY);
+        }
+#if defined(MADV_HUGEPAGE)
+        (void)madvise(region, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    if (node != NHUGEMEM_ANY_NODE) {
+        nerror                  error;
+
+        error = hugemem_bind(region, size, node);
+
+        if (error != NERROR_NONE) {
+            (void)munmap(region, size);
+
+            return (error);
+        }
+    }
+    huge_obj->region      = region;
+    huge_obj->region_size = size;
+    n_mem_init(&huge_obj->mem_class, tlsf_init_alloc, region, size, 1u);
+
+    NOBLIGATION(NSIGNATURE_IS(&huge_obj->mem_class, NSIGNATURE_TLSF));
+
+    return (NERROR_NONE);
+}
+
+
+
+void nhugemem_term(struct nhugemem * huge_obj)
+{
+    NREQUIRE(huge_obj);
+    NREQUIRE(NSIGNATURE_OF(&huge_obj->mem_class) == NSIGNATURE_TLSF);
+
+    (void)munmap(huge_obj->region, huge_obj->region_size);
+    huge_obj->region = NULL;
+
+    NOBLIGATION(NSIGNATURE_IS(&huge_obj->mem_class, 0));
+}
+
+
+
+bool nhugemem_is_hugetlb(const struct nhugemem * huge_obj)
+{
+    NREQUIRE(huge_obj);
+
+    return (huge_obj->is_hugetlb);
+}
+
+#endif /* (CONFIG_HUGEMEM == 1) */
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of hugemem.c
+ ******************************************************************************/
@@ -0,0 +1,383 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Lock-free pool memory management implementation
+ * @addtogroup  mm_lfpool
+ *********************************************************************//** @{ */
+/**@defgroup    mm_lfpool_impl Implementation
+ * @brief       Lock-free pool memory management implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+
+#include "port/core.h"
+#include "base/debug.h"
+#include "base/bitop.h"
+#include "mm/lfpool.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+/**@brief       The lower half of stack top is block index plus one, the upper
+ *              half is the version counter
+ */
+#define TOP_INDEX_BITS                  (sizeof(uintptr_t) * 4u)
+
+#define TOP_INDEX_MASK                  (((uintptr_t)1u << TOP_INDEX_BITS) - 1u)
+
+#define TOP_INDEX(top)                  ((top) & TOP_INDEX_MASK)
+
+#define TOP_NEXT_VERSION(top)                                                   \
+    (((top) & ~TOP_INDEX_MASK) + ((uintptr_t)1u << TOP_INDEX_BITS))
+
+#define BLOCK(head, index)                                                      \
+    ((struct lfpool_block *)((head)->blocks + ((index) - 1u) * (head)->block_size))
+
+#define BLOCK_INDEX(head, block)                                                \
+    ((uintptr_t)(((uint8_t *)(block) - (head)->blocks) / (head)->block_size) + 1u)
+
+/**@brief       Link a free block, the link may be read concurrently by a thread
+ *              which is about to lose the race in @ref stack_pop
+ */
+#if defined(__GNUC__)
+#define BLOCK_SET_NEXT(block, index)                                            \
+    __atomic_store_n(&(block)->next, (index), __ATOMIC_RELAXED)
+#else
+#define BLOCK_SET_NEXT(block, index)    (block)->next = (index)
+#endif
+
+#if (CONFIG_LFPOOL_CACHE != 0) && defined(PORT_C_THREAD_LOCAL)
+#define LFPOOL_USE_CACHE                1
+
+/**@brief       Number of pools which a thread may cache at the same time
+ */
+#define LFPOOL_CACHE_SLOTS              4u
+#endif
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/**@brief       Free block header
+ */
+struct lfpool_block
+{
+    uintptr_t                   next;   /**<@brief Index of next block + 1  */
+};
+
+#if defined(LFPOOL_USE_CACHE)
+/**@brief       Blocks of a pool cached by a thread
+ */
+struct lfpool_cache
+{
+    struct nmem *               pool;
+    uintptr_t                   first;
+    uintptr_t                   last;
+    uint32_t                    count;
+};
+#endif
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static struct lfpool_block * stack_pop(struct nmem * pool_obj);
+
+/**@brief       Push a chain of blocks linked by their next indexes
+ */
+static void stack_push(struct nmem * pool_obj, uintptr_t first,
+        uintptr_t last, uint32_t count);
+
+#if defined(LFPOOL_USE_CACHE)
+static struct lfpool_cache * cache_get(struct nmem * pool_obj);
+
+static void cache_flush(struct lfpool_cache * cache);
+#endif
+
+static void * lfpool_alloc(struct nmem * pool_obj, size_t size);
+
+static void lfpool_free(struct nmem * pool_obj, void * mem);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+#if defined(LFPOOL_USE_CACHE)
+static PORT_C_THREAD_LOCAL struct lfpool_cache g_cache[LFPOOL_CACHE_SLOTS];
+#endif
+
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static struct lfpool_block * stack_pop(struct nmem * pool_obj)
+{
+    struct nlfpool_head *       head = pool_obj->base;
+    struct lfpool_block *       block;
+
+#if defined(__GNUC__)
+    uintptr_t                   top;
+    uintptr_t                   next;
+
+    top = __atomic_load_n(&head->top, __ATOMIC_ACQUIRE);
+
+    do {
+        if (TOP_INDEX(top) == 0u) {
+
+            return (NULL);
+        }
+        block = BLOCK(head, TOP_INDEX(top));
+
+        /* NOTE:
+         * The block may be popped and reused by another thread before the
+         * exchange below. In that case the next index is garbage, but the
+         * version of the top has changed and the exchange fails.
+         */
+        next  = __atomic_load_n(&block->next, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&head->top, &top,
+                TOP_NEXT_VERSION(top) | next, true, __ATOMIC_ACQ_REL,
+                __ATOMIC_ACQUIRE));
+    __atomic_sub_fetch(&pool_obj->free, head->block_size, __ATOMIC_RELAXED);
+#else
+    struct ncore_lock           lock;
+
+    ncore_lock_enter(&lock);
+
+    if (TOP_INDEX(head->top) == 0u) {
+        block = NULL;
+    } else {
+        block           = BLOCK(head, TOP_INDEX(head->top));
+        head->top       = TOP_NEXT_VERSION(head->top) | block->next;
+        pool_obj->free -= head->block_size;
+    }
+    ncore_lock_exit(&lock);
+#endif
+
+    return (block);
+}
+
+
+
+static void stack_push(struct nmem * pool_obj, uintptr_t first,
+        uintptr_t last, uint32_t count)
+{
+    struct nlfpool_head *       head = pool_obj->base;
+    struct lfpool_block *       tail = BLOCK(head, last);
+
+#if defined(__GNUC__)
+    uintptr_t                   top;
+
+    top = __atomic_load_n(&head->top, __ATOMIC_RELAXED);
+
+    do {
+        BLOCK_SET_NEXT(tail, TOP_INDEX(top));
+    } while (!__atomic_compare_exchange_n(&head->top, &top,
+                TOP_NEXT_VERSION(top) | first, true, __ATOMIC_RELEASE,
+                __ATOMIC_RELAXED));
+    __atomic_add_fetch(&pool_obj->free, head->block_size * count,
+        __ATOMIC_RELAXED);
+#else
+    struct ncore_lock           lock;
+
+    ncore_lock_enter(&lock);
+    tail->next      = TOP_INDEX(head->top);
+    head->top       = TOP_NEXT_VERSION(head->top) | first;
+    pool_obj->free += head->block_size * count;
+    ncore_lock_exit(&lock);
+#endif
+}
+
+
+
+#if defined(LFPOOL_USE_CACHE)
+static struct lfpool_cache * cache_get(struct nmem * pool_obj)
+{
+    struct lfpool_cache *       cache;
+
+    cache = &g_cache[((uintptr_t)pool_obj / sizeof(struct nmem)) %
+        LFPOOL_CACHE_SLOTS];
+
+    if (cache->pool != pool_obj) {
+                                        /* Slot is used by another pool, give */
+                                        /* back its blocks.                   */
+        cache_flush(cache);
+        cache->pool = pool_obj;
+    }
+
+    return (cache);
+}
+
+
+
+static void cache_flush(struct lfpool_cache * cache)
+{
+    if (cache->count != 0u) {
+        stack_push(cache->pool, cache->first, cache->last, cache->count);
+        cache->first = 0u;
+        cache->count = 0u;
+    }
+}
+#endif
+
+
+
+static void * lfpool_alloc(struct nmem * pool_obj, size_t size)
+{
+#if defined(LFPOOL_USE_CACHE)
+    struct lfpool_cache *       cache;
+#endif
+
+    NREQUIRE(NSIGNATURE_OF(pool_obj) == NSIGNATURE_LFPOOL);
+    NREQUIRE(size <= ((struct nlfpool_head *)pool_obj->base)->block_size);
+
+    (void)size;
+
+#if defined(LFPOOL_USE_CACHE)
+    cache = cache_get(pool_obj);
+
+    if (cache->count != 0u) {
+        struct lfpool_block *   block;
+
+        block        = BLOCK((struct nlfpool_head *)pool_obj->base,
+            cache->first);
+        cache->first = block->next;
+        cache->count--;
+
+        return ((void *)block);
+    }
+#endif
+
+    return ((void *)stack_pop(pool_obj));
+}
+
+
+
+static void lfpool_free(struct nmem * pool_obj, void * mem)
+{
+    struct nlfpool_head *       head;
+    uintptr_t                   index;
+
+    NREQUIRE(NSIGNATURE_OF(pool_obj) == NSIGNATURE_LFPOOL);
+    NREQUIRE(mem);
+
+    head  = pool_obj->base;
+    index = BLOCK_INDEX(head, mem);
+
+    NREQUIRE((index >= 1u) && (index <= pool_obj->no_blocks));
+
+#if defined(LFPOOL_USE_CACHE)
+    {
+        struct lfpool_cache *   cache = cache_get(pool_obj);
+
+        if (cache->count == CONFIG_LFPOOL_CACHE) {
+            cache_flush(cache);
+        }
+        BLOCK_SET_NEXT((struct lfpool_block *)mem, cache->first);
+
+        if (cache->count == 0u) {
+            cache->last = index;
+        }
+        cache->first = index;
+        cache->count++;
+    }
+#else
+    stack_push(pool_obj, index, index, 1u);
+#endif
+}
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+void * lfpool_init_alloc(struct nmem * pool_obj, size_t size)
+{
+    ncore_lock                  lock;
+
+    NREQUIRE(NSIGNATURE_OF(pool_obj) == NSIGNATURE_LFPOOL);
+    NREQUIRE(pool_obj->base);
+    NREQUIRE(pool_obj->no_blocks >= 1u);
+    NREQUIRE(pool_obj->no_blocks < TOP_INDEX_MASK);
+
+    /* NOTE:
+     * Threads which do not use the core lock may race to the first
+     * allocation, so the pool is built only once under the lock.
+     */
+    ncore_lock_enter(&lock);
+
+    if (pool_obj->vf_alloc == lfpool_init_alloc) {
+        struct nlfpool_head *   head = pool_obj->base;
+        uintptr_t               index;
+
+        head->blocks     = (uint8_t *)(head + 1);
+        head->block_size = (pool_obj->size - sizeof(*head)) /
+            pool_obj->no_blocks;
+        head->top        = 1u;
+
+        NREQUIRE(head->block_size >= sizeof(struct lfpool_block));
+
+        for (index = 1u; index < pool_obj->no_blocks; index++) {
+            BLOCK(head, index)->next = index + 1u;
+        }
+        BLOCK(head, index)->next = 0u;
+        pool_obj->size     = head->block_size * pool_obj->no_blocks;
+        pool_obj->free     = pool_obj->size;
+        pool_obj->vf_free  = lfpool_free;
+#if defined(__GNUC__)
+        __atomic_store_n(&pool_obj->vf_alloc, lfpool_alloc, __ATOMIC_RELEASE);
+#else
+        pool_obj->vf_alloc = lfpool_alloc;
+#endif
+    }
+    ncore_lock_exit(&lock);
+
+    return (lfpool_alloc(pool_obj, size));
+}
+
+
+
+void * nlfpool_alloc(struct nmem * pool_obj)
+{
+    NREQUIRE(NSIGNATURE_OF(pool_obj) == NSIGNATURE_LFPOOL);
+
+    return (pool_obj->vf_alloc(pool_obj, 0u));
+}
+
+
+
+void nlfpool_free(struct nmem * pool_obj, void * mem)
+{
+    lfpool_free(pool_obj, mem);
+}
+
+
+
+void nlfpool_cache_flush(void)
+{
+#if defined(LFPOOL_USE_CACHE)
+    uint32_t                    slot;
+
+    for (slot = 0u; slot < LFPOOL_CACHE_SLOTS; slot++) {
+        cache_flush(&g_cache[slot]);
+        g_cache[slot].pool = NULL;
+    }
+#endif
+}
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of lfpool.c
+ ******************************************************************************/
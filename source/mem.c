@@ -36,17 +36,290 @@
 #include "mm/mem.h"
 
 /*=========================================================  LOCAL MACRO's  ==*/
+
+#if defined(PORT_C_RETURN_ADDRESS)
+#define MEM_CALL_SITE()                 PORT_C_RETURN_ADDRESS()
+#else
+#define MEM_CALL_SITE()                 NULL
+#endif
+
 /*======================================================  LOCAL DATA TYPES  ==*/
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+/**@brief       Set up a bundle memory object which was not used yet
+ * @details     The optional virtual functions are installed by the first
+ *              allocation.
+ */
+static void mem_setup(struct nmem * mem_obj);
+
+static void * mem_alloc_aligned(struct nmem * mem_obj, size_t size,
+        size_t align, const void * site);
+
+static void * mem_realloc(struct nmem * mem_obj, void * mem_storage,
+        size_t old_size, size_t new_size, const void * site);
+
+#if (CONFIG_MEM_STATS == 1)
+static uint_fast8_t stats_bucket(size_t size);
+
+/**@brief       Account an allocation request
+ */
+static void stats_alloc(struct nmem * mem_obj, size_t size,
+        const void * mem_storage, const void * site);
+
+static void stats_free(struct nmem * mem_obj);
+
+# if (CONFIG_MEM_STATS_SITES != 0u)
+/**@brief       Find or claim the entry of a call site
+ */
+static struct nmem_site * stats_site(const struct nmem * mem_obj,
+        const void * site);
+# endif
+#endif
+
 /*=======================================================  LOCAL VARIABLES  ==*/
+
+#if (CONFIG_MEM_STATS == 1) && (CONFIG_MEM_STATS_SITES != 0u)
+static struct nmem_site         g_mem_sites[CONFIG_MEM_STATS_SITES];
+#endif
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 
 struct nmem *                   g_generic_heap_;
 
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static void mem_setup(struct nmem * mem_obj)
+{
+    if (mem_obj->vf_free == NULL) {
+        void *                  mem_storage;
+
+        mem_storage = mem_obj->vf_alloc(mem_obj, 1u);
+
+        if (mem_storage && mem_obj->vf_free_sized) {
+            mem_obj->vf_free_sized(mem_obj, mem_storage, 1u);
+        } else if (mem_storage) {
+            mem_obj->vf_free(mem_obj, mem_storage);
+        }
+    }
+}
+
+
+
+static void * mem_alloc_aligned(struct nmem * mem_obj, size_t size,
+        size_t align, const void * site)
+{
+    void *                      mem_storage;
+
+    NREQUIRE((align != 0u) && ((align & (align - 1u)) == 0u));
+
+    if ((mem_obj->vf_alloc_aligned == NULL) &&
+        (align > NCPU_DATA_ALIGNMENT)) {
+        mem_setup(mem_obj);
+    }
+
+    if (mem_obj->vf_alloc_aligned) {
+        mem_storage = mem_obj->vf_alloc_aligned(mem_obj, size, align);
+    } else if (align <= NCPU_DATA_ALIGNMENT) {
+        mem_storage = mem_obj->vf_alloc(mem_obj, size);
+    } else {
+        mem_storage = NULL;
+    }
+#if (CONFIG_MEM_STATS == 1)
+    stats_alloc(mem_obj, size, mem_storage, site);
+#else
+    (void)site;
+#endif
+
+    return (mem_storage);
+}
+
+
+
+static void * mem_realloc(struct nmem * mem_obj, void * mem_storage,
+        size_t old_size, size_t new_size, const void * site)
+{
+    void *                      new_storage;
+
+    if (mem_storage == NULL) {
+        new_storage = mem_obj->vf_alloc(mem_obj, new_size);
+    } else if (mem_obj->vf_realloc) {
+        new_storage = mem_obj->vf_realloc(mem_obj, mem_storage, old_size,
+            new_size);
+#if (CONFIG_MEM_STATS == 1)
+        /* NOTE:
+         * The old block is released by the reallocation, account it as a
+         * free so n_alloc - n_free still gives the number of live blocks.
+         */
+        if (new_storage) {
+            stats_free(mem_obj);
+        }
+#endif
+    } else {
+        new_storage = mem_obj->vf_alloc(mem_obj, new_size);
+
+        if (new_storage) {
+            memcpy(new_storage, mem_storage,
+                old_size < new_size ? old_size : new_size);
+            nmem_free_sized_i(mem_obj, mem_storage, old_size);
+        }
+    }
+#if (CONFIG_MEM_STATS == 1)
+    stats_alloc(mem_obj, new_size, new_storage, site);
+#else
+    (void)site;
+#endif
+
+    return (new_storage);
+}
+
+
+
+#if (CONFIG_MEM_STATS == 1)
+static uint_fast8_t stats_bucket(size_t size)
+{
+    uint_fast8_t                bucket = 0u;
+
+    while (((size >>= 1u) != 0u) && (bucket < NMEM_STATS_BUCKETS - 1u)) {
+        bucket++;
+    }
+
+    return (bucket);
+}
+
+
+
+static void stats_alloc(struct nmem * mem_obj, size_t size,
+        const void * mem_storage, const void * site)
+{
+#if (CONFIG_MEM_STATS_SITES != 0u)
+    struct nmem_site *          entry;
+#endif
+
+    mem_obj->stats.histogram[stats_bucket(size)]++;
+#if (CONFIG_MEM_STATS_SITES != 0u)
+    entry = stats_site(mem_obj, site);
+#else
+    (void)site;
+#endif
+
+    if (mem_storage) {
+        mem_obj->stats.n_alloc++;
+        mem_obj->stats.used = mem_obj->size - mem_obj->free;
+
+        if (mem_obj->stats.peak < mem_obj->stats.used) {
+            mem_obj->stats.peak = mem_obj->stats.used;
+        }
+#if (CONFIG_MEM_STATS_SITES != 0u)
+        if (entry) {
+            entry->n_alloc++;
+            entry->bytes += size;
+        }
+#endif
+    } else {
+        mem_obj->stats.n_fail++;
+#if (CONFIG_MEM_STATS_SITES != 0u)
+        if (entry) {
+            entry->n_fail++;
+        }
+#endif
+    }
+}
+
+
+
+static void stats_free(struct nmem * mem_obj)
+{
+    mem_obj->stats.n_free++;
+    mem_obj->stats.used = mem_obj->size - mem_obj->free;
+}
+
+
+
+# if (CONFIG_MEM_STATS_SITES != 0u)
+static struct nmem_site * stats_site(const struct nmem * mem_obj,
+        const void * site)
+{
+    uint32_t                    idx;
+    uint32_t                    probe;
+
+    idx = (uint32_t)(((uintptr_t)site ^ ((uintptr_t)mem_obj >> 4u)) %
+        CONFIG_MEM_STATS_SITES);
+
+    for (probe = 0u; probe < CONFIG_MEM_STATS_SITES; probe++) {
+        struct nmem_site *      entry = &g_mem_sites[idx];
+
+        if (entry->mem == NULL) {
+            entry->site = site;
+            entry->mem  = mem_obj;
+
+            return (entry);
+        }
+
+        if ((entry->site == site) && (entry->mem == mem_obj)) {
+
+            return (entry);
+        }
+        idx = (idx + 1u) % CONFIG_MEM_STATS_SITES;
+    }
+
+    return (NULL);
+}
+# endif
+#endif
+
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
 
 
+#if (CONFIG_MEM_STATS == 1)
+void * n_mem_stats_alloc_i(struct nmem * mem_obj, size_t size,
+        const void * site)
+{
+    void *                      mem_storage;
+
+    mem_storage = mem_obj->vf_alloc(mem_obj, size);
+    stats_alloc(mem_obj, size, mem_storage, site);
+
+    return (mem_storage);
+}
+
+
+
+void n_mem_stats_free_i(struct nmem * mem_obj, void * mem_storage)
+{
+    mem_obj->vf_free(mem_obj, mem_storage);
+    stats_free(mem_obj);
+}
+#endif
+
+
+
+void n_mem_init(struct nmem * mem_obj,
+        void * (* init_alloc)(struct nmem *, size_t), void * storage,
+        size_t size, uint32_t no_blocks)
+{
+    NREQUIRE(mem_obj);
+    NREQUIRE(init_alloc);
+    NREQUIRE(storage);
+
+    mem_obj->vf_alloc         = init_alloc;
+    mem_obj->vf_free          = NULL;
+    mem_obj->vf_alloc_aligned = NULL;
+    mem_obj->vf_realloc       = NULL;
+    mem_obj->vf_free_sized    = NULL;
+    mem_obj->base             = storage;
+    mem_obj->cursor           = NULL;
+    mem_obj->free             = 0u;
+    mem_obj->size             = size;
+    mem_obj->no_blocks        = no_blocks;
+#if (CONFIG_MEM_STATS == 1)
+    mem_obj->vf_largest = NULL;
+    memset(&mem_obj->stats, 0, sizeof(mem_obj->stats));
+#endif
+}
+
+
+
 void * nmem_alloc(struct nmem * mem, size_t size)
 {
     ncore_lock                  sys_lock;
@@ -63,9 +336,16 @@ void * nmem_alloc(struct nmem * mem, size_t size)
 
 void * nmem_zalloc(struct nmem * mem, size_t size)
 {
+    ncore_lock                  sys_lock;
     void *                      mem_storage;
 
-    mem_storage = nmem_alloc(mem, size);
+    /* NOTE:
+     * Do not call nmem_alloc() here, the allocation would be attributed to
+     * this function instead to the caller.
+     */
+    ncore_lock_enter(&sys_lock);
+    mem_storage = nmem_alloc_i(mem, size);
+    ncore_lock_exit(&sys_lock);
 
     if (mem_storage) {
         memset(mem_storage, 0, size);
@@ -85,6 +365,136 @@ void nmem_free(struct nmem * mem, void * mem_storage)
     ncore_lock_exit(&sys_lock);
 }
 
+
+
+void * nmem_alloc_aligned_i(struct nmem * mem_obj, size_t size, size_t align)
+{
+    return (mem_alloc_aligned(mem_obj, size, align, MEM_CALL_SITE()));
+}
+
+
+
+void * nmem_alloc_aligned(struct nmem * mem_obj, size_t size, size_t align)
+{
+    ncore_lock                  sys_lock;
+    void *                      mem_storage;
+
+    ncore_lock_enter(&sys_lock);
+    mem_storage = mem_alloc_aligned(mem_obj, size, align, MEM_CALL_SITE());
+    ncore_lock_exit(&sys_lock);
+
+    return (mem_storage);
+}
+
+
+
+void * nmem_realloc_i(struct nmem * mem_obj, void * mem_storage,
+        size_t old_size, size_t new_size)
+{
+    return (mem_realloc(mem_obj, mem_storage, old_size, new_size,
+        MEM_CALL_SITE()));
+}
+
+
+
+void * nmem_realloc(struct nmem * mem_obj, void * mem_storage,
+        size_t old_size, size_t new_size)
+{
+    ncore_lock                  sys_lock;
+    void *                      new_storage;
+
+    ncore_lock_enter(&sys_lock);
+    new_storage = mem_realloc(mem_obj, mem_storage, old_size, new_size,
+        MEM_CALL_SITE());
+    ncore_lock_exit(&sys_lock);
+
+    return (new_storage);
+}
+
+
+
+void nmem_free_sized_i(struct nmem * mem_obj, void * mem_storage,
+        size_t size)
+{
+    if (mem_obj->vf_free_sized) {
+        mem_obj->vf_free_sized(mem_obj, mem_storage, size);
+    } else {
+        mem_obj->vf_free(mem_obj, mem_storage);
+    }
+#if (CONFIG_MEM_STATS == 1)
+    stats_free(mem_obj);
+#endif
+}
+
+
+
+void nmem_free_sized(struct nmem * mem_obj, void * mem_storage, size_t size)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+    nmem_free_sized_i(mem_obj, mem_storage, size);
+    ncore_lock_exit(&sys_lock);
+}
+
+
+
+#if (CONFIG_MEM_STATS == 1)
+void nmem_get_stats(struct nmem * mem_obj, struct nmem_stats * stats)
+{
+    ncore_lock                  sys_lock;
+
+    NREQUIRE(N_IS_MEM_OBJECT(mem_obj));
+    NREQUIRE(stats);
+
+    ncore_lock_enter(&sys_lock);
+    *stats = mem_obj->stats;
+
+    if (stats->n_alloc == 0u) {
+                                        /* Object may not be initialized yet, */
+                                        /* its free bytes are not valid.      */
+        stats->free         = mem_obj->size;
+        stats->largest_free = mem_obj->size;
+    } else {
+        stats->free         = mem_obj->free;
+        stats->largest_free = mem_obj->vf_largest ?
+            mem_obj->vf_largest(mem_obj) : mem_obj->free;
+    }
+    ncore_lock_exit(&sys_lock);
+    stats->fragmentation = stats->free != 0u ?
+        (uint32_t)(100u - (stats->largest_free * 100u) / stats->free) : 0u;
+}
+
+
+
+size_t nmem_get_sites(struct nmem_site * sites, size_t n_sites)
+{
+    size_t                      count = 0u;
+#if (CONFIG_MEM_STATS_SITES != 0u)
+    ncore_lock                  sys_lock;
+    uint32_t                    idx;
+
+    NREQUIRE(sites || !n_sites);
+
+    ncore_lock_enter(&sys_lock);
+
+    for (idx = 0u; (idx < CONFIG_MEM_STATS_SITES) && (count < n_sites);
+         idx++) {
+
+        if (g_mem_sites[idx].mem != NULL) {
+            sites[count++] = g_mem_sites[idx];
+        }
+    }
+    ncore_lock_exit(&sys_lock);
+#else
+    (void)sites;
+    (void)n_sites;
+#endif
+
+    return (count);
+}
+#endif
+
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 /** @endcond *//** @} *//******************************************************
  * END of mem_class.c
@@ -50,6 +50,14 @@ static void * pool_alloc(struct nmem * pool_obj, size_t size);
 
 static void pool_free(struct nmem * pool_obj, void * mem);
 
+static void * pool_alloc_aligned(struct nmem * pool_obj, size_t size,
+        size_t align);
+
+static void * pool_realloc(struct nmem * pool_obj, void * mem,
+        size_t old_size, size_t new_size);
+
+static void pool_free_sized(struct nmem * pool_obj, void * mem, size_t size);
+
 /*=======================================================  LOCAL VARIABLES  ==*/
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
@@ -64,9 +72,18 @@ static void * pool_alloc(struct nmem * pool_obj, size_t size)
     block = pool_obj->base;
     (void)size;
 
+    /* NOTE:
+     * Free list holds only recycled blocks. When it is empty all free blocks
+     * are the ones which were never used, they are taken from cursor.
+     */
     if (block != NULL) {
         pool_obj->base  = block->next;
         pool_obj->free -= pool_obj->size / pool_obj->no_blocks;
+    } else if (pool_obj->free != 0u) {
+        block            = pool_obj->cursor;
+        pool_obj->cursor = (uint8_t *)block + pool_obj->size /
+            pool_obj->no_blocks;
+        pool_obj->free  -= pool_obj->size / pool_obj->no_blocks;
     }
     NENSURE(block);
 
@@ -87,36 +104,128 @@ static void pool_free(struct nmem * pool_obj, void * mem)
     pool_obj->free += pool_obj->size / pool_obj->no_blocks;
 }
 
+static void * pool_alloc_aligned(struct nmem * pool_obj, size_t size,
+        size_t align)
+{
+    struct pool_block *         prev;
+    struct pool_block *         block;
+    size_t                      block_size;
+    size_t                      unused;
+
+    NREQUIRE(NSIGNATURE_OF(pool_obj) == NSIGNATURE_POOL);
+    NREQUIRE(size <= pool_obj->size / pool_obj->no_blocks);
+    NREQUIRE(ncore_is_lock_valid());
+
+    (void)size;
+    block_size = pool_obj->size / pool_obj->no_blocks;
+    unused     = pool_obj->free / block_size;
+    prev       = NULL;
+    block      = pool_obj->base;
+
+    /* NOTE:
+     * When block size is a multiple of alignment the first block is already
+     * aligned, otherwise only some blocks are and they are searched for.
+     */
+    while ((block != NULL) && (((uintptr_t)block & (align - 1u)) != 0u)) {
+        prev  = block;
+        block = block->next;
+        unused--;
+    }
+
+    if (block != NULL) {
+
+        if (prev != NULL) {
+            prev->next     = block->next;
+        } else {
+            pool_obj->base = block->next;
+        }
+        pool_obj->free -= block_size;
+
+        return ((void *)block);
+    }
+                                        /* Blocks skipped at cursor are put   */
+                                        /* to free list.                      */
+    while (unused-- != 0u) {
+        block            = pool_obj->cursor;
+        pool_obj->cursor = (uint8_t *)block + block_size;
+
+        if (((uintptr_t)block & (align - 1u)) == 0u) {
+            pool_obj->free -= block_size;
+
+            return ((void *)block);
+        }
+        block->next    = pool_obj->base;
+        pool_obj->base = block;
+    }
+
+    return (NULL);
+}
+
+static void * pool_realloc(struct nmem * pool_obj, void * mem,
+        size_t old_size, size_t new_size)
+{
+    NREQUIRE(NSIGNATURE_OF(pool_obj) == NSIGNATURE_POOL);
+    NREQUIRE(mem);
+
+    (void)old_size;
+                                        /* Blocks can not grow or move to     */
+                                        /* larger blocks.                     */
+    return (new_size <= pool_obj->size / pool_obj->no_blocks ? mem : NULL);
+}
+
+static void pool_free_sized(struct nmem * pool_obj, void * mem, size_t size)
+{
+    NREQUIRE(size <= pool_obj->size / pool_obj->no_blocks);
+
+    (void)size;
+    pool_free(pool_obj, mem);
+}
+
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
 
 
 void * pool_init_alloc(struct nmem * pool_obj, size_t size)
 {
-    size_t                      block_size;
-    size_t                      block_cnt;
-    size_t                      nblocks;
-    struct pool_block *         block;
-
     NREQUIRE(NSIGNATURE_OF(pool_obj) == NSIGNATURE_POOL);
     NREQUIRE(pool_obj->base);
-    NREQUIRE(pool_obj->size < INT32_MAX);
     NREQUIRE(pool_obj->no_blocks >= 1);
 
-    for (block_cnt = 0u, block_size = pool_obj->size / pool_obj->no_blocks;
-        block_cnt < pool_obj->no_blocks - 1u; 
-        block_cnt++) {
-        block->next =
-            (struct pool_block *)((uint8_t *)block + pool_obj->size);
-        block = block->next;
-    }
-    block->next = NULL;
+    (void)size;
+
+    /* NOTE:
+     * Blocks are not linked here, they are given from cursor on first use.
+     * Initialization does not depend on pool size and storage pages are not
+     * touched until blocks are used.
+     */
+    pool_obj->cursor = pool_obj->base;
+    pool_obj->base   = NULL;
+    pool_obj->free   = pool_obj->size;
 
     pool_obj->vf_alloc = pool_alloc;
     pool_obj->vf_free  = pool_free;
+    pool_obj->vf_alloc_aligned = pool_alloc_aligned;
+    pool_obj->vf_realloc       = pool_realloc;
+    pool_obj->vf_free_sized    = pool_free_sized;
 
     return (pool_alloc(pool_obj, 0));
 }
 
+
+
+void npool_init(struct nmem * pool_obj, void * storage, size_t block_size,
+        uint32_t n_blocks)
+{
+    NREQUIRE(pool_obj);
+    NREQUIRE(NSIGNATURE_OF(pool_obj) != NSIGNATURE_POOL);
+    NREQUIRE(block_size >= sizeof(struct pool_block));
+    NREQUIRE(n_blocks >= 1u);
+
+    n_mem_init(pool_obj, pool_init_alloc, storage,
+        NPOOL_COMPUTE_SIZE(n_blocks, block_size), n_blocks);
+
+    NOBLIGATION(NSIGNATURE_IS(pool_obj, NSIGNATURE_POOL));
+}
+
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 /** @endcond *//** @} *//** @} *//*********************************************
  * END of pool.c
@@ -432,10 +432,12 @@ void nthread_schedule(void)
     struct nthread *            thread;
 
     ncore_lock_enter(&lock);
+    ncore_os_set_dispatcher();
 
     for (;!ncore_os_should_exit();) {
         thread = sched_schedule_i(ctx);  /* Fetch a new thread for execution. */
         thread->vf_dispatch_i(thread, &lock);
+        ctx->current = NULL;          /* Outside of any thread dispatch again */
     }
     ncore_lock_exit(&lock);
 }
@@ -451,6 +453,24 @@ struct nthread * nthread_get_current(void)
 
 
 
+uint_fast8_t nthread_get_current_priority(void)
+{
+    struct sched_ctx *          ctx = &g_sched_ctx;
+
+    /* NOTE:
+     * The current thread is kept while its handler runs with the core lock
+     * released, so other threads and interrupts would see it, too.
+     */
+    if ((ctx->current == NULL) || !ncore_os_is_dispatcher()) {
+
+        return (0u);
+    }
+
+    return (nbias_list_get_bias(ctx->current));
+}
+
+
+
 void ntask_init(struct ntask * task, const char * name, uint8_t priority, 
         void (* vf_task)(struct ntask *, void * arg), void * arg)
 {
@@ -0,0 +1,448 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Slab memory management implementation
+ * @addtogroup  mm_slab
+ *********************************************************************//** @{ */
+/**@defgroup    mm_slab_impl Implementation
+ * @brief       Slab memory management implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <string.h>
+
+#include "port/core.h"
+#include "base/debug.h"
+#include "base/bitop.h"
+#include "mm/slab.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+#define BITMAP_WORDS(n_objects)         NDIVISION_ROUNDUP(n_objects, 32u)
+
+/**@brief       Slabs are not aligned to their size, a slab starting in the
+ *              previous lookup key range may contain the address too
+ */
+#define HASH_KEY(address)               ((uintptr_t)(address) / CONFIG_SLAB_SIZE)
+
+#define HASH_BUCKET(key)                ((key) % NSLAB_HASH_SIZE)
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/**@brief       Slab header, placed at the beginning of each slab
+ */
+struct nslab_page
+{
+    struct nslab_page *         next;       /**<@brief Partial list       */
+    struct nslab_page *         prev;
+    struct nslab_page *         hash_next;
+    struct nslab_cache *        cache;
+    uint8_t *                   objects;
+    uint32_t                    n_free;
+    uint32_t                    bitmap[];   /**<@brief Set bit: free obj  */
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static uint_fast8_t slab_ffs(uint32_t value);
+
+static void partial_insert(struct nslab_cache * cache,
+        struct nslab_page * page);
+
+static void partial_remove(struct nslab_cache * cache,
+        struct nslab_page * page);
+
+static struct nslab_page * page_lookup(struct nslab * slab, const void * mem);
+
+static struct nslab_page * page_create(struct nslab_cache * cache);
+
+static void page_destroy(struct nslab_cache * cache, struct nslab_page * page);
+
+static void * slab_alloc(struct nmem * mem_class, size_t size);
+
+static void slab_free(struct nmem * mem_class, void * mem);
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+/**@brief       Index of the least significant set bit
+ */
+static uint_fast8_t slab_ffs(uint32_t value)
+{
+#if defined(__GNUC__)
+    return ((uint_fast8_t)__builtin_ctz(value));
+#else
+    uint_fast8_t                bit = 0u;
+
+    while ((value & 0x1u) == 0u) {
+        value >>= 1u;
+        bit++;
+    }
+
+    return (bit);
+#endif
+}
+
+
+
+static void partial_insert(struct nslab_cache * cache,
+        struct nslab_page * page)
+{
+    page->prev = NULL;
+    page->next = cache->partial;
+
+    if (page->next) {
+        page->next->prev = page;
+    }
+    cache->partial = page;
+}
+
+
+
+static void partial_remove(struct nslab_cache * cache,
+        struct nslab_page * page)
+{
+    if (page->next) {
+        page->next->prev = page->prev;
+    }
+
+    if (page->prev) {
+        page->prev->next = page->next;
+    } else {
+        cache->partial = page->next;
+    }
+}
+
+
+
+static struct nslab_page * page_lookup(struct nslab * slab, const void * mem)
+{
+    uintptr_t                   key;
+    uint_fast8_t                cnt;
+
+    key = HASH_KEY(mem);
+
+    for (cnt = 0u; cnt < 2u; cnt++, key--) {
+        struct nslab_page *     page;
+
+        for (page = slab->hash[HASH_BUCKET(key)]; page; page = page->hash_next) {
+
+            if (((const uint8_t *)mem >= (uint8_t *)page) &&
+                ((const uint8_t *)mem <  (uint8_t *)page + CONFIG_SLAB_SIZE)) {
+
+                return (page);
+            }
+        }
+    }
+
+    return (NULL);
+}
+
+
+
+static struct nslab_page * page_create(struct nslab_cache * cache)
+{
+    struct nslab *              slab = cache->slab;
+    struct nslab_page *         page;
+    struct nslab_page **        bucket;
+    uint32_t                    words;
+    uint32_t                    cnt;
+    uintptr_t                   objects;
+
+    page = nmem_alloc_i(slab->backing, CONFIG_SLAB_SIZE);
+
+    if (page == NULL) {
+
+        return (NULL);
+    }
+    words = BITMAP_WORDS(cache->per_slab);
+
+    for (cnt = 0u; cnt < words; cnt++) {
+        page->bitmap[cnt] = UINT32_MAX;
+    }
+
+    if (cache->per_slab % 32u) {
+        page->bitmap[words - 1u] = ((uint32_t)1u << (cache->per_slab % 32u)) - 1u;
+    }
+                                        /* Align the first object and shift   */
+                                        /* it by the color of this slab.      */
+    objects         = (uintptr_t)&page->bitmap[words];
+    objects         = NALIGN_UP(objects, (uintptr_t)CONFIG_SLAB_ALIGN);
+    page->objects   = (uint8_t *)objects + cache->color * CONFIG_SLAB_ALIGN;
+    page->n_free    = cache->per_slab;
+    page->cache     = cache;
+    cache->color    = (cache->color + 1u) % cache->colors;
+    cache->n_slabs++;
+
+    bucket          = &slab->hash[HASH_BUCKET(HASH_KEY(page))];
+    page->hash_next = *bucket;
+    *bucket         = page;
+    partial_insert(cache, page);
+
+    slab->mem_class.size += CONFIG_SLAB_SIZE;
+    slab->mem_class.free += cache->per_slab * cache->size;
+
+    return (page);
+}
+
+
+
+static void page_destroy(struct nslab_cache * cache, struct nslab_page * page)
+{
+    struct nslab *              slab = cache->slab;
+    struct nslab_page **        link;
+
+    partial_remove(cache, page);
+    link = &slab->hash[HASH_BUCKET(HASH_KEY(page))];
+
+    while (*link != page) {
+        link = &(*link)->hash_next;
+    }
+    *link = page->hash_next;
+    cache->n_slabs--;
+    slab->mem_class.size -= CONFIG_SLAB_SIZE;
+    slab->mem_class.free -= cache->per_slab * cache->size;
+    nmem_free_i(slab->backing, page);
+}
+
+
+
+static void * slab_alloc(struct nmem * mem_class, size_t size)
+{
+    struct nslab *              slab;
+    struct nslab_cache *        cache;
+
+    NREQUIRE(NSIGNATURE_OF(mem_class) == NSIGNATURE_SLAB);
+
+    slab = PORT_C_CONTAINER_OF(mem_class, struct nslab, mem_class);
+
+    for (cache = slab->caches; cache; cache = cache->next) {
+
+        if (cache->size >= size) {
+
+            return (nslab_cache_alloc_i(cache));
+        }
+    }
+
+    return (NULL);
+}
+
+
+
+static void slab_free(struct nmem * mem_class, void * mem)
+{
+    struct nslab *              slab;
+    struct nslab_page *         page;
+
+    NREQUIRE(NSIGNATURE_OF(mem_class) == NSIGNATURE_SLAB);
+
+    slab = PORT_C_CONTAINER_OF(mem_class, struct nslab, mem_class);
+    page = page_lookup(slab, mem);
+
+    NREQUIRE(page);
+
+    nslab_cache_free_i(page->cache, mem);
+}
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+void nslab_init(struct nslab * slab, struct nmem * backing)
+{
+    uint32_t                    bucket;
+
+    NREQUIRE(slab);
+    NREQUIRE(NSIGNATURE_OF(&slab->mem_class) != NSIGNATURE_SLAB);
+    NREQUIRE(N_IS_MEM_OBJECT(backing));
+
+    slab->mem_class.base             = NULL;
+    slab->mem_class.cursor           = NULL;
+    slab->mem_class.size             = 0u;
+    slab->mem_class.free             = 0u;
+    slab->mem_class.no_blocks        = 0u;
+    slab->mem_class.vf_alloc         = slab_alloc;
+    slab->mem_class.vf_free          = slab_free;
+    slab->mem_class.vf_alloc_aligned = NULL;
+    slab->mem_class.vf_realloc       = NULL;
+    slab->mem_class.vf_free_sized    = NULL;
+#if (CONFIG_MEM_STATS == 1)
+    slab->mem_class.vf_largest       = NULL;
+    memset(&slab->mem_class.stats, 0, sizeof(slab->mem_class.stats));
+#endif
+    slab->backing            = backing;
+    slab->caches             = NULL;
+
+    for (bucket = 0u; bucket < NSLAB_HASH_SIZE; bucket++) {
+        slab->hash[bucket] = NULL;
+    }
+
+    NOBLIGATION(NSIGNATURE_IS(&slab->mem_class, NSIGNATURE_SLAB));
+}
+
+
+
+void nslab_cache_init(struct nslab * slab, struct nslab_cache * cache,
+        const char * name, size_t size)
+{
+    struct nslab_cache **       link;
+    size_t                      usable;
+    size_t                      leftover;
+    uint32_t                    n;
+
+    NREQUIRE(NSIGNATURE_OF(&slab->mem_class) == NSIGNATURE_SLAB);
+    NREQUIRE(cache);
+    NREQUIRE(size != 0u);
+
+    size   = NALIGN_UP(size, (size_t)CONFIG_SLAB_ALIGN);
+                                        /* Reserve space for aligning the     */
+                                        /* first object of unaligned slab.    */
+    usable = CONFIG_SLAB_SIZE - offsetof(struct nslab_page, bitmap) -
+        (CONFIG_SLAB_ALIGN - 1u);
+
+    NREQUIRE(usable > size + sizeof(uint32_t));
+
+    n = (uint32_t)(usable / size);
+
+    while ((n * size + BITMAP_WORDS(n) * sizeof(uint32_t)) > usable) {
+        n--;
+    }
+    leftover        = usable - n * size - BITMAP_WORDS(n) * sizeof(uint32_t);
+    cache->name     = name;
+    cache->slab     = slab;
+    cache->partial  = NULL;
+    cache->size     = size;
+    cache->per_slab = n;
+    cache->colors   = (uint32_t)(leftover / CONFIG_SLAB_ALIGN) + 1u;
+    cache->color    = 0u;
+    cache->n_slabs  = 0u;
+
+    link = &slab->caches;
+
+    while (*link && ((*link)->size < size)) {
+        link = &(*link)->next;
+    }
+    cache->next = *link;
+    *link       = cache;
+}
+
+
+
+void * nslab_cache_alloc_i(struct nslab_cache * cache)
+{
+    struct nslab_page *         page;
+    uint32_t                    word;
+    uint32_t                    index;
+
+    NREQUIRE(cache && cache->slab);
+    NREQUIRE(ncore_is_lock_valid());
+
+    page = cache->partial;
+
+    if (page == NULL) {
+        page = page_create(cache);
+
+        if (page == NULL) {
+
+            return (NULL);
+        }
+    }
+
+    for (word = 0u; page->bitmap[word] == 0u; word++);
+
+    index               = word * 32u + slab_ffs(page->bitmap[word]);
+    page->bitmap[word] &= page->bitmap[word] - 1u;
+    page->n_free--;
+    cache->slab->mem_class.free -= cache->size;
+
+    if (page->n_free == 0u) {
+        partial_remove(cache, page);
+    }
+
+    return ((void *)(page->objects + index * cache->size));
+}
+
+
+
+void * nslab_cache_alloc(struct nslab_cache * cache)
+{
+    ncore_lock                  lock;
+    void *                      mem;
+
+    ncore_lock_enter(&lock);
+    mem = nslab_cache_alloc_i(cache);
+    ncore_lock_exit(&lock);
+
+    return (mem);
+}
+
+
+
+void nslab_cache_free_i(struct nslab_cache * cache, void * mem)
+{
+    struct nslab_page *         page;
+    uint32_t                    index;
+
+    NREQUIRE(cache && cache->slab);
+    NREQUIRE(mem);
+    NREQUIRE(ncore_is_lock_valid());
+
+    page  = page_lookup(cache->slab, mem);
+
+    NREQUIRE(page && (page->cache == cache));
+
+    index = (uint32_t)(((uint8_t *)mem - page->objects) / cache->size);
+
+    NREQUIRE((page->bitmap[index / 32u] & ((uint32_t)1u << (index % 32u))) == 0u);
+
+    page->bitmap[index / 32u] |= (uint32_t)1u << (index % 32u);
+    page->n_free++;
+    cache->slab->mem_class.free += cache->size;
+
+    if (page->n_free == 1u) {
+        partial_insert(cache, page);
+    }
+                                        /* Keep the last slab with free space */
+                                        /* to avoid slab thrashing.           */
+    if ((page->n_free == cache->per_slab) && (page->prev || page->next)) {
+        page_destroy(cache, page);
+    }
+}
+
+
+
+void nslab_cache_free(struct nslab_cache * cache, void * mem)
+{
+    ncore_lock                  lock;
+
+    ncore_lock_enter(&lock);
+    nslab_cache_free_i(cache, mem);
+    ncore_lock_exit(&lock);
+}
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of slab.c
+ ******************************************************************************/
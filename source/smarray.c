@@ -0,0 +1,287 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       State machine array implementation
+ * @addtogroup  eds_smarray
+ *********************************************************************//** @{ */
+/**@defgroup    eds_smarray_impl Implementation
+ * @brief       State machine array Implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include "base/debug.h"
+#include "ep/event.h"
+#include "ep/smp.h"
+#include "ep/smarray.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+/**@brief       Number of instances whose transitions are looked up at once
+ */
+#define ARRAY_CHUNK                     64u
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static void array_dispatch(struct nsm_array * array, uint32_t instance,
+        const struct nevent * event);
+
+#if (CONFIG_SMP_TABLE == 1)
+static void array_table_dispatch(struct nsm_array * array, uint32_t instance,
+        const struct nevent * event);
+#endif
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+static void array_dispatch(struct nsm_array * array, uint32_t instance,
+        const struct nevent * event)
+{
+    array->current  = instance;
+    array->sm.state = array->state[instance];
+    nsm_dispatch(&array->sm, event);
+    array->state[instance] = array->sm.state;
+}
+
+
+
+#if (CONFIG_SMP_TABLE == 1)
+static void array_table_dispatch(struct nsm_array * array, uint32_t instance,
+        const struct nevent * event)
+{
+    array->current        = instance;
+    array->sm.table_state = array->table_state[instance];
+    n_sm_table_dispatch(&array->sm, event);
+    array->table_state[instance] = (uint16_t)array->sm.table_state;
+}
+#endif
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+void nsm_array_init(struct nsm_array * array, nstate ** state, uint32_t n,
+        nstate * init_state, enum nsm_type type, void * wspace)
+{
+    uint32_t                    idx;
+
+    NREQUIRE(array);
+    NREQUIRE(NSIGNATURE_OF(array) != NSIGNATURE_SM_ARRAY);
+    NREQUIRE(state && n);
+    NREQUIRE(init_state);
+    NREQUIRE((type == NSM_TYPE_FSM) || (type == NSM_TYPE_HSM));
+
+    for (idx = 0u; idx < n; idx++) {
+        state[idx] = init_state;
+    }
+    array->sm.vf_dispatch = type == NSM_TYPE_FSM ? n_sm_fsm_dispatch :
+                                                   n_sm_hsm_dispatch;
+    array->sm.state       = init_state;
+    array->sm.wspace      = wspace;
+    array->n              = n;
+    array->current        = 0u;
+    array->state          = state;
+#if (CONFIG_SMP_TABLE == 1)
+    array->sm.table       = NULL;
+    array->table_state    = NULL;
+#endif
+
+    NOBLIGATION(NSIGNATURE_IS(&array->sm, NSIGNATURE_SM));
+    NOBLIGATION(NSIGNATURE_IS(array, NSIGNATURE_SM_ARRAY));
+}
+
+
+
+#if (CONFIG_SMP_TABLE == 1)
+void nsm_array_init_table(struct nsm_array * array, uint16_t * table_state,
+        uint32_t n, const struct nsm_table * table, void * wspace)
+{
+    uint32_t                    idx;
+
+    NREQUIRE(array);
+    NREQUIRE(NSIGNATURE_OF(array) != NSIGNATURE_SM_ARRAY);
+    NREQUIRE(table_state && n);
+
+    for (idx = 0u; idx < n; idx++) {
+        table_state[idx] = NSM_TABLE_NONE;
+    }
+    NOBLIGATION(NSIGNATURE_IS(&array->sm, NSIGNATURE_SM));
+    nsm_table_init(&array->sm, table);
+    array->sm.state       = NULL;
+    array->sm.wspace      = wspace;
+    array->n              = n;
+    array->current        = 0u;
+    array->state          = NULL;
+    array->table_state    = table_state;
+
+    NOBLIGATION(NSIGNATURE_IS(array, NSIGNATURE_SM_ARRAY));
+}
+#endif
+
+
+
+void nsm_array_start(struct nsm_array * array)
+{
+    NREQUIRE(N_IS_SM_ARRAY_OBJECT(array));
+
+    nsm_array_broadcast(array, nsm_event(NSM_INIT));
+}
+
+
+
+void nsm_array_dispatch(struct nsm_array * array, const uint32_t * instance,
+        const struct nevent * const * event, size_t count)
+{
+    size_t                      idx;
+
+    NREQUIRE(N_IS_SM_ARRAY_OBJECT(array));
+    NREQUIRE(instance && (event || !count));
+
+#if (CONFIG_SMP_TABLE == 1)
+    if (array->table_state) {
+        const struct nsm_table * table = array->sm.table;
+
+        for (idx = 0u; idx < count; idx += ARRAY_CHUNK) {
+            uint16_t            seen[ARRAY_CHUNK];
+            uint16_t            hit[ARRAY_CHUNK];
+            size_t              chunk;
+            size_t              cnt;
+
+            chunk = count - idx < ARRAY_CHUNK ? count - idx : ARRAY_CHUNK;
+
+            /* NOTE:
+             * First pass only loads states and looks up transitions so it
+             * does not call any function. Events sent before the instance
+             * has started always go to dispatcher.
+             */
+            for (cnt = 0u; cnt < chunk; cnt++) {
+                uint_fast16_t   column;
+                uint16_t        state;
+
+                NREQUIRE(instance[idx + cnt] < array->n);
+
+                column    = (uint_fast16_t)(event[idx + cnt]->id -
+                    table->event_base);
+                state     = array->table_state[instance[idx + cnt]];
+                seen[cnt] = state;
+
+                if (state == NSM_TABLE_NONE) {
+                    hit[cnt] = 0u;
+                } else if (column < table->n_events) {
+                    hit[cnt] = table->map[state * table->n_events + column];
+                } else {
+                    hit[cnt] = NSM_TABLE_NONE;
+                }
+            }
+
+            /* NOTE:
+             * An instance which appears twice in the chunk may have changed
+             * its state after the first pass, so it is dispatched anyway.
+             */
+            for (cnt = 0u; cnt < chunk; cnt++) {
+                uint32_t        target = instance[idx + cnt];
+
+                if ((hit[cnt] != NSM_TABLE_NONE) ||
+                    (array->table_state[target] != seen[cnt])) {
+                    array_table_dispatch(array, target, event[idx + cnt]);
+                }
+            }
+        }
+
+        return;
+    }
+#endif
+
+    for (idx = 0u; idx < count; idx++) {
+        NREQUIRE(instance[idx] < array->n);
+
+        array_dispatch(array, instance[idx], event[idx]);
+    }
+}
+
+
+
+void nsm_array_broadcast(struct nsm_array * array,
+        const struct nevent * event)
+{
+    uint32_t                    idx;
+
+    NREQUIRE(N_IS_SM_ARRAY_OBJECT(array));
+
+#if (CONFIG_SMP_TABLE == 1)
+    if (array->table_state) {
+        const struct nsm_table * table = array->sm.table;
+        uint_fast16_t           column;
+
+        column = (uint_fast16_t)(event->id - table->event_base);
+
+        if ((event->id == NSM_INIT) || (column >= table->n_events)) {
+
+            for (idx = 0u; idx < array->n; idx++) {
+                array_table_dispatch(array, idx, event);
+            }
+
+            return;
+        }
+
+        for (idx = 0u; idx < array->n; idx += ARRAY_CHUNK) {
+            const uint16_t *    state = &array->table_state[idx];
+            uint16_t            hit[ARRAY_CHUNK];
+            uint32_t            chunk;
+            uint32_t            cnt;
+
+            chunk = array->n - idx < ARRAY_CHUNK ? array->n - idx : ARRAY_CHUNK;
+
+            /* NOTE:
+             * Gather loop without function calls, it is vectorized by the
+             * compiler. Instances which were not started are skipped.
+             */
+            for (cnt = 0u; cnt < chunk; cnt++) {
+                hit[cnt] = state[cnt] != NSM_TABLE_NONE ?
+                    table->map[state[cnt] * table->n_events + column] :
+                    NSM_TABLE_NONE;
+            }
+
+            for (cnt = 0u; cnt < chunk; cnt++) {
+
+                if (hit[cnt] != NSM_TABLE_NONE) {
+                    array_table_dispatch(array, idx + cnt, event);
+                }
+            }
+        }
+
+        return;
+    }
+#endif
+
+    for (idx = 0u; idx < array->n; idx++) {
+        array_dispatch(array, idx, event);
+    }
+}
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of smarray.c
+ ******************************************************************************/
@@ -31,6 +31,7 @@
 /*=========================================================  INCLUDE FILES  ==*/
 
 #include <stdbool.h>
+#include <string.h>
 
 #include "base/debug.h"
 #include "ep/event.h"
@@ -43,30 +44,91 @@
 /*=========================================================  LOCAL MACRO's  ==*/
 /*======================================================  LOCAL DATA TYPES  ==*/
 
+/**@brief       Cached hierarchy information of a state
+ */
+struct hsm_state
+{
+    nstate *                    state;
+    nstate *                    super;
+    uint_fast16_t               depth;  /**<@brief 0 when not yet known  */
+#if (CONFIG_SMP_HSM_HANDLER_CACHE != 0u)
+    const uint16_t *            ids;    /**<@brief Handled events or NULL */
+    size_t                      n_ids;
+#endif
+};
+
+/**@brief       Cached transition path
+ */
 struct hsm_path
 {
-    nstate *                    buff[CONFIG_SMP_HSM_PATH_DEPTH];
-    uint_fast8_t                index;
+    nstate *                    source;
+    nstate *                    target;
+    nstate *                    lca;    /**<@brief Least common ancestor  */
 };
 
+#if (CONFIG_SMP_HSM_HANDLER_CACHE != 0u)
+/**@brief       Memoized event handler
+ */
+struct hsm_handler
+{
+    nstate *                    state;
+    uint_fast16_t               id;
+    nstate *                    handler;/**<@brief NULL if event is ignored*/
+};
+#endif
+
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
 
 static nstate * hsm_get_state_super(struct nsm * sm, nstate * state);
 
-/**@brief       Finds transition path
- * @param       sm
- *              State machine
- * @param       srcCount
- *              Index for source starting position
- * @return      Index for destination starting position
+static uint_fast16_t hsm_hash(nstate * state);
+
+/**@brief       Find the cache slot of a state
+ * @return      Slot holding the state, an empty slot where the state may be
+ *              inserted or NULL when the cache is full.
+ */
+static struct hsm_state * hsm_state_find(nstate * state);
+
+static nstate * hsm_super(struct nsm * sm, nstate * state);
+
+static uint_fast16_t hsm_depth(struct nsm * sm, nstate * state);
+
+/**@brief       Finds the state where transition path turns
+ * @details     States from the current state up to, but excluding, the
+ *              returned state are exited and states below the returned state
+ *              down to target are entered.
  * @notapi
  */
-static void hsm_build_path(struct nsm * sm, struct hsm_path * entry,
-    struct hsm_path * exit);
+static nstate * hsm_build_path(struct nsm * sm, nstate * source,
+    nstate * target);
 
-static void hsm_path_enter(struct nsm * sm, const struct hsm_path * entry);
+static void hsm_path_enter(struct nsm * sm, nstate * state, nstate * lca);
+
+static void hsm_path_exit(struct nsm * sm, nstate * state, nstate * lca);
+
+#if (CONFIG_SMP_HSM_HANDLER_CACHE != 0u)
+static bool hsm_state_handles(const struct hsm_state * slot, uint_fast16_t id);
+
+/**@brief       Find the first state, starting from @c state, which may handle
+ *              the event
+ * @return      State function or NULL when no state handles the event
+ */
+static nstate * hsm_handler(struct nsm * sm, nstate * state, uint_fast16_t id);
+#endif
 
-static void hsm_path_exit(struct nsm * sm, const struct hsm_path * exit);
+#if (CONFIG_SMP_TABLE == 1)
+static void table_path_enter(struct nsm * sm, const struct nsm_table * table,
+    uint_fast16_t state, uint_fast16_t lca);
+
+static void table_path_exit(struct nsm * sm, const struct nsm_table * table,
+    uint_fast16_t state, uint_fast16_t lca);
+
+/**@brief       Follow initial transitions of composite states
+ * @return      Index of leaf state which becomes the current state
+ */
+static uint_fast16_t table_path_init(struct nsm * sm,
+    const struct nsm_table * table, uint_fast16_t state);
+#endif
 
 /*=======================================================  LOCAL VARIABLES  ==*/
 
@@ -82,6 +144,14 @@ static const struct nevent g_smp_events[4] =
     NEVENT_INITIALIZER(NSM_INIT,  NULL, sizeof(struct nevent))
 };
 
+static struct hsm_state         g_hsm_state[CONFIG_SMP_HSM_STATE_CACHE];
+
+static struct hsm_path          g_hsm_path[CONFIG_SMP_HSM_PATH_CACHE];
+
+#if (CONFIG_SMP_HSM_HANDLER_CACHE != 0u)
+static struct hsm_handler       g_hsm_handler[CONFIG_SMP_HSM_HANDLER_CACHE];
+#endif
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
 
@@ -100,120 +170,276 @@ static nstate * hsm_get_state_super(struct nsm * sm, nstate * state)
     return (sm->state);
 }
 
-static void hsm_build_path(struct nsm * sm, struct hsm_path * entry,
-    struct hsm_path * exit)
+static uint_fast16_t hsm_hash(nstate * state)
 {
-    nstate *                    current_state;
-    entry->index = 0;
-    exit->index--;
+    uintptr_t                   key = (uintptr_t)state;
 
-/*--  path: a) source ?== destination  ---------------------------------------*/
-    if (exit->buff[exit->index] == entry->buff[entry->index]) {
-        entry->index++;
-        exit->index++;
+    return ((uint_fast16_t)((key >> 4) ^ (key >> 12)));
+}
 
-        return;
-    }
-/*--  path: b) source ?== super(destination)  --------------------------------*/
-    current_state = hsm_get_state_super(sm, entry->buff[entry->index++]);
-    entry->buff[entry->index] = current_state;
+static struct hsm_state * hsm_state_find(nstate * state)
+{
+    uint_fast16_t               idx;
+    uint_fast16_t               probe;
 
-    if (exit->buff[exit->index] == entry->buff[entry->index]) {
+    idx = hsm_hash(state);
 
-        return;
+    for (probe = 0u; probe < CONFIG_SMP_HSM_STATE_CACHE; probe++) {
+        struct hsm_state *      slot;
+
+        slot = &g_hsm_state[(idx + probe) & (CONFIG_SMP_HSM_STATE_CACHE - 1u)];
+
+        if ((slot->state == state) || (slot->state == NULL)) {
+
+            return (slot);
+        }
     }
-/*--  path: c) super(source) ?== super(destination)  -------------------------*/
-    current_state = hsm_get_state_super(sm, exit->buff[exit->index++]);
-    exit->buff[exit->index] = current_state;
 
-    if (exit->buff[exit->index] == entry->buff[entry->index]) {
+    return (NULL);
+}
 
-        return;
+static nstate * hsm_super(struct nsm * sm, nstate * state)
+{
+    struct hsm_state *          slot;
+    nstate *                    super;
+
+    slot = hsm_state_find(state);
+
+    if (slot && (slot->state == state) && slot->super) {
+
+        return (slot->super);
     }
-/*--  path: d) super(source) ?== destination  --------------------------------*/
-    entry->index--;
+    super = hsm_get_state_super(sm, state);
 
-    if (exit->buff[exit->index] == entry->buff[entry->index]) {
+    if (slot) {
+        slot->state = state;
+        slot->super = super;
+    }
 
-        return;
+    return (super);
+}
+
+static uint_fast16_t hsm_depth(struct nsm * sm, nstate * state)
+{
+    struct hsm_state *          slot;
+    uint_fast16_t               depth;
+
+    if (state == &ntop_state) {
+
+        return (0u);
     }
-/*--  path: e) source ?== ...super(super(destination))  ----------------------*/
-    exit->index--;
-    entry->index++;
+    slot = hsm_state_find(state);
 
-    while (entry->buff[entry->index] != &ntop_state) {
-        current_state = hsm_get_state_super(sm, entry->buff[entry->index++]);
-        entry->buff[entry->index] = current_state;
+    if (slot && (slot->state == state) && (slot->depth != 0u)) {
 
-        if (exit->buff[exit->index] == entry->buff[entry->index]) {
+        return (slot->depth);
+    }
+    depth = hsm_depth(sm, hsm_super(sm, state)) + 1u;
+    slot  = hsm_state_find(state);
 
-            return;
-        }
+    if (slot && (slot->state == state)) {
+        slot->depth = depth;
     }
-/*--  path: f) super(source) ?== ...super(super(destination))  ---------------*/
-    exit->index++;
 
-    while (entry->index != 1u) {
+    return (depth);
+}
+
+static nstate * hsm_build_path(struct nsm * sm, nstate * source,
+    nstate * target)
+{
+    struct hsm_path *           path;
+    nstate *                    source_up;
+    nstate *                    target_up;
+    uint_fast16_t               source_depth;
+    uint_fast16_t               target_depth;
 
-        if (exit->buff[exit->index] == entry->buff[entry->index]) {
+    path = &g_hsm_path[(hsm_hash(source) ^ hsm_hash(target) * 3u) &
+        (CONFIG_SMP_HSM_PATH_CACHE - 1u)];
 
-            return;
-        }
-        entry->index--;
+    if ((path->source == source) && (path->target == target)) {
+
+        return (path->lca);
     }
-/*--  path: g) ...super(super(source)) ?== ...super(super(destination))  -----*/
+    path->source = source;
+    path->target = target;
 
-    for (;;) {
-        current_state = hsm_get_state_super(sm, exit->buff[exit->index++]);
-        exit->buff[exit->index] = current_state;
-        entry->index = 0u;
+/*--  path: a) source ?== destination  ---------------------------------------*/
+    if (source == target) {
+        path->lca = hsm_super(sm, source);
 
-        do {
-            entry->index++;
+        return (path->lca);
+    }
+/*--  path: b) super(source) ?== destination  --------------------------------*/
+    if (hsm_super(sm, source) == target) {
+        path->lca = target;
 
-            if (exit->buff[exit->index] == entry->buff[entry->index]) {
+        return (path->lca);
+    }
+/*--  path: c) least common ancestor of source and destination  -------------*/
+    source_up    = source;
+    target_up    = target;
+    source_depth = hsm_depth(sm, source);
+    target_depth = hsm_depth(sm, target);
+
+    while (source_depth > target_depth) {
+        source_up = hsm_super(sm, source_up);
+        source_depth--;
+    }
 
-                return;
-            }
+    while (target_depth > source_depth) {
+        target_up = hsm_super(sm, target_up);
+        target_depth--;
+    }
 
-        } while (entry->buff[entry->index] != &ntop_state);
+    while (source_up != target_up) {
+        source_up = hsm_super(sm, source_up);
+        target_up = hsm_super(sm, target_up);
+    }
+/*--  path: d) destination ?== ...super(super(source))  ----------------------*/
+    if (source_up == target) {
+        source_up = hsm_super(sm, target);
     }
+    path->lca = source_up;
+
+    return (path->lca);
 }
 
-static void hsm_path_enter(struct nsm * sm, const struct hsm_path * entry)
+static void hsm_path_enter(struct nsm * sm, nstate * state, nstate * lca)
 {
-    uint_fast8_t                index = entry->index;
-
-    while (index--) {
+    /* NOTE:
+     * States are entered from the outermost one, the recursion depth equals
+     * the number of states being entered.
+     */
+    if (state != lca) {
 #if (CONFIG_API_VALIDATION == 1)
         naction                 ret;
 
-        ret = entry->buff[index](sm, NSMP_EVENT(NSM_ENTRY));
+        hsm_path_enter(sm, hsm_super(sm, state), lca);
+        ret = state(sm, NSMP_EVENT(NSM_ENTRY));
         NREQUIRE((ret == NACTION_IGNORED) || (ret == NACTION_HANDLED) ||
                  (ret == NACTION_SUPER));
 #else
-        (void)entry->buff[index](sm, NSMP_EVENT(NSM_ENTRY));
+        hsm_path_enter(sm, hsm_super(sm, state), lca);
+        (void)state(sm, NSMP_EVENT(NSM_ENTRY));
 #endif
     }
 }
 
-static void hsm_path_exit(struct nsm * sm, const struct hsm_path * exit)
+static void hsm_path_exit(struct nsm * sm, nstate * state, nstate * lca)
 {
-    uint_fast8_t                count;
-
-    for (count = 0; count < exit->index; count++) {
+    while (state != lca) {
 #if (CONFIG_API_VALIDATION == 1)
         naction                 ret;
 
-        ret = exit->buff[count](sm, NSMP_EVENT(NSM_EXIT));
+        ret = state(sm, NSMP_EVENT(NSM_EXIT));
         NREQUIRE((ret == NACTION_IGNORED) || (ret == NACTION_HANDLED) ||
                  (ret == NACTION_SUPER));
 #else
-        (void)exit->buff[count](sm, NSMP_EVENT(NSM_EXIT));
+        (void)state(sm, NSMP_EVENT(NSM_EXIT));
 #endif
+        state = hsm_super(sm, state);
+    }
+}
+
+#if (CONFIG_SMP_HSM_HANDLER_CACHE != 0u)
+static bool hsm_state_handles(const struct hsm_state * slot, uint_fast16_t id)
+{
+    size_t                      low;
+    size_t                      high;
+
+    low  = 0u;
+    high = slot->n_ids;
+
+    while (low < high) {
+        size_t                  mid = low + (high - low) / 2u;
+
+        if (slot->ids[mid] < id) {
+            low  = mid + 1u;
+        } else {
+            high = mid;
+        }
     }
+
+    return ((low < slot->n_ids) && (slot->ids[low] == id));
 }
 
+static nstate * hsm_handler(struct nsm * sm, nstate * state, uint_fast16_t id)
+{
+    struct hsm_handler *        memo;
+    nstate *                    handler;
+
+    memo = &g_hsm_handler[(hsm_hash(state) ^ (id * 0x9e37u)) &
+        (CONFIG_SMP_HSM_HANDLER_CACHE - 1u)];
+
+    if ((memo->state == state) && (memo->id == id)) {
+
+        return (memo->handler);
+    }
+    handler = state;
+
+    while (handler != &ntop_state) {
+        const struct hsm_state * slot;
+
+        slot = hsm_state_find(handler);
+
+        if (!slot || (slot->state != handler) || !slot->ids ||
+            hsm_state_handles(slot, id)) {
+
+            break;
+        }
+        handler = hsm_super(sm, handler);
+    }
+
+    if (handler == &ntop_state) {
+        handler = NULL;
+    }
+    memo->state   = state;
+    memo->id      = id;
+    memo->handler = handler;
+
+    return (handler);
+}
+#endif
+
+#if (CONFIG_SMP_TABLE == 1)
+static void table_path_enter(struct nsm * sm, const struct nsm_table * table,
+    uint_fast16_t state, uint_fast16_t lca)
+{
+    if (state != lca) {
+        table_path_enter(sm, table, table->state[state].parent, lca);
+
+        if (table->state[state].entry) {
+            table->state[state].entry(sm, NSMP_EVENT(NSM_ENTRY));
+        }
+    }
+}
+
+static void table_path_exit(struct nsm * sm, const struct nsm_table * table,
+    uint_fast16_t state, uint_fast16_t lca)
+{
+    while (state != lca) {
+
+        if (table->state[state].exit) {
+            table->state[state].exit(sm, NSMP_EVENT(NSM_EXIT));
+        }
+        state = table->state[state].parent;
+    }
+}
+
+static uint_fast16_t table_path_init(struct nsm * sm,
+    const struct nsm_table * table, uint_fast16_t state)
+{
+    while (table->state[state].init != NSM_TABLE_NONE) {
+        uint_fast16_t           init = table->state[state].init;
+
+        table_path_enter(sm, table, init, state);
+        state = init;
+    }
+
+    return (state);
+}
+#endif
+
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
 
 #if (CONFIG_DYNAMIC_SM == 1) || defined(__DOXYGEN__)
@@ -281,26 +507,41 @@ void n_sm_hsm_dispatch(struct nsm * sm, const struct nevent * event)
 {
     naction                     ret;
     nstate *                    current_state;
-    struct hsm_path             entry;
-    struct hsm_path             exit;
+    nstate *                    source;
 
-    exit.index = 0u;
     current_state = sm->state;
+#if (CONFIG_SMP_HSM_HANDLER_CACHE != 0u)
+    source        = hsm_handler(sm, current_state, event->id);
+    ret           = NACTION_IGNORED;
+
+    while (source) {
+        ret = source(sm, event);
+
+        if (ret != NACTION_SUPER) {
+            break;
+        }
+        source = hsm_handler(sm, sm->state, event->id);
+        ret    = NACTION_IGNORED;
+    }
+#else
 
     do {
-        exit.buff[exit.index++] = sm->state;
-        ret = sm->state(sm, event);
+        source = sm->state;
+        ret    = source(sm, event);
     } while (ret == NACTION_SUPER);
+#endif
 
     while (ret == NACTION_TRANSIT_TO) {
-        entry.buff[0] = sm->state;
-        hsm_build_path(sm, &entry, &exit);
-        hsm_path_exit(sm, &exit);
-        hsm_path_enter(sm, &entry);
-        ret = entry.buff[0](sm, NSMP_EVENT(NSM_INIT));
-        exit.buff[0]  = entry.buff[0];
-        current_state = entry.buff[0];
-        exit.index = 1u;
+        nstate *                target;
+        nstate *                lca;
+
+        target = sm->state;
+        lca    = hsm_build_path(sm, source, target);
+        hsm_path_exit(sm, current_state, lca);
+        hsm_path_enter(sm, target, lca);
+        ret = target(sm, NSMP_EVENT(NSM_INIT));
+        source        = target;
+        current_state = target;
     }
     sm->state = current_state;
 }
@@ -332,6 +573,103 @@ void n_sm_fsm_dispatch(struct nsm * sm, const struct nevent * event)
     sm->state = current_state;
 }
 
+#if (CONFIG_SMP_HSM_HANDLER_CACHE != 0u)
+nerror nsm_state_handles(nstate * state, const uint16_t * ids, size_t n_ids)
+{
+    struct hsm_state *          slot;
+    size_t                      idx;
+
+    NREQUIRE(state && (state != &ntop_state));
+    NREQUIRE(ids || !n_ids);
+
+    for (idx = 1u; idx < n_ids; idx++) {
+        NREQUIRE(ids[idx - 1u] < ids[idx]);
+    }
+    slot = hsm_state_find(state);
+
+    if (!slot) {
+
+        return (NERROR_NO_RESOURCE);
+    }
+    slot->state = state;
+    slot->ids   = ids;
+    slot->n_ids = n_ids;
+
+    /* NOTE:
+     * Handlers memoized so far may have skipped or stopped at this state.
+     */
+    memset(g_hsm_handler, 0, sizeof(g_hsm_handler));
+
+    return (NERROR_NONE);
+}
+#endif
+
+#if (CONFIG_SMP_TABLE == 1)
+void nsm_table_init(struct nsm * sm, const struct nsm_table * table)
+{
+    NREQUIRE(N_IS_SM_OBJECT(sm));
+    NREQUIRE(table && (table->initial < table->n_states));
+
+    sm->table       = table;
+    sm->table_state = NSM_TABLE_NONE;
+    sm->vf_dispatch = n_sm_table_dispatch;
+}
+
+void n_sm_table_dispatch(struct nsm * sm, const struct nevent * event)
+{
+    const struct nsm_table *    table = sm->table;
+    const struct nsm_table_transition * transition;
+    uint_fast16_t               column;
+    uint_fast16_t               idx;
+
+    if (sm->table_state == NSM_TABLE_NONE) {
+        NREQUIRE(event->id == NSM_INIT);
+
+        table_path_enter(sm, table, table->initial, NSM_TABLE_NONE);
+        sm->table_state = table_path_init(sm, table, table->initial);
+
+        return;
+    }
+    /* NOTE:
+     * Event ids below event_base wrap around and fall out of table too.
+     */
+    column = (uint_fast16_t)(event->id - table->event_base);
+
+    if (column >= table->n_events) {
+
+        return;
+    }
+    idx = table->map[sm->table_state * table->n_events + column];
+
+    while (idx != NSM_TABLE_NONE) {
+        transition = &table->transition[idx];
+
+        if (!transition->guard || transition->guard(sm, event)) {
+            break;
+        }
+        idx = transition->next;
+    }
+
+    if (idx == NSM_TABLE_NONE) {
+
+        return;
+    }
+    /* NOTE:
+     * The action is executed before exit actions, the same order in which a
+     * state function executes its code before returning naction_transit_to().
+     */
+    if (transition->action) {
+        transition->action(sm, event);
+    }
+
+    if (transition->target != NSM_TABLE_NONE) {
+        table_path_exit(sm, table, sm->table_state, transition->lca);
+        table_path_enter(sm, table, transition->target, transition->lca);
+        sm->table_state = table_path_init(sm, table, transition->target);
+    }
+}
+#endif
+
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 
 /** @endcond *//** @} *//******************************************************
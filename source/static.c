@@ -30,6 +30,8 @@
 
 /*=========================================================  INCLUDE FILES  ==*/
 
+#include <string.h>
+
 #include "port/core.h"
 #include "base/bitop.h"
 #include "mm/static.h"
@@ -42,6 +44,15 @@ static void * static_alloc(struct nmem * static_obj, size_t size);
 
 static void static_free(struct nmem * static_obj, void * mem);
 
+static void * static_alloc_aligned(struct nmem * static_obj, size_t size,
+        size_t align);
+
+static void * static_realloc(struct nmem * static_obj, void * mem,
+        size_t old_size, size_t new_size);
+
+static void static_free_sized(struct nmem * static_obj, void * mem,
+        size_t size);
+
 /*=======================================================  LOCAL VARIABLES  ==*/
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
@@ -72,6 +83,69 @@ static void static_free(struct nmem * static_obj, void * mem)
     NASSERT_ALWAYS("illegal static memory call");
 }
 
+static void * static_alloc_aligned(struct nmem * static_obj, size_t size,
+        size_t align)
+{
+    uintptr_t                   base;
+    uintptr_t                   start;
+
+    NREQUIRE(NSIGNATURE_IS(static_obj, NSIGNATURE_STATIC));
+    NREQUIRE((size != 0u) && (size < INT32_MAX));
+    NREQUIRE(ncore_is_lock_valid());
+
+    size = NALIGN_UP(size, (size_t)NCPU_DATA_ALIGNMENT);
+
+    if (size > static_obj->free) {
+
+        return (NULL);
+    }
+    base  = (uintptr_t)static_obj->base;
+    start = NALIGN(base + static_obj->free - size, (uintptr_t)align);
+
+    if (start < base) {
+
+        return (NULL);
+    }
+    static_obj->free = (size_t)(start - base);
+
+    return ((void *)start);
+}
+
+static void * static_realloc(struct nmem * static_obj, void * mem,
+        size_t old_size, size_t new_size)
+{
+    void *                      new_mem;
+
+    if (NALIGN_UP(new_size, (size_t)NCPU_DATA_ALIGNMENT) <=
+        NALIGN_UP(old_size, (size_t)NCPU_DATA_ALIGNMENT)) {
+
+        return (mem);
+    }
+                                        /* Old memory can not be reused       */
+    new_mem = static_alloc(static_obj, new_size);
+
+    if (new_mem) {
+        memcpy(new_mem, mem, old_size);
+    }
+
+    return (new_mem);
+}
+
+static void static_free_sized(struct nmem * static_obj, void * mem,
+        size_t size)
+{
+    NREQUIRE(NSIGNATURE_IS(static_obj, NSIGNATURE_STATIC));
+    NREQUIRE(ncore_is_lock_valid());
+
+    /* NOTE:
+     * Only the most recent allocation can be returned, other memory is not
+     * reused.
+     */
+    if (mem == &((uint8_t *)static_obj->base)[static_obj->free]) {
+        static_obj->free += NALIGN_UP(size, (size_t)NCPU_DATA_ALIGNMENT);
+    }
+}
+
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
 
 void * static_init_alloc(struct nmem * static_obj, size_t size)
@@ -83,6 +157,9 @@ void * static_init_alloc(struct nmem * static_obj, size_t size)
     static_obj->free     = static_obj->size;
     static_obj->vf_alloc = static_alloc;
     static_obj->vf_free  = static_free;
+    static_obj->vf_alloc_aligned = static_alloc_aligned;
+    static_obj->vf_realloc       = static_realloc;
+    static_obj->vf_free_sized    = static_free_sized;
 
     return (static_alloc(static_obj, size));
 }
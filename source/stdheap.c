@@ -31,6 +31,7 @@
 /*=========================================================  INCLUDE FILES  ==*/
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "port/core.h"
 #include "mm/stdheap.h"
@@ -44,6 +45,10 @@
  */
 #define N_IS_STDHEAP_OBJECT(mem_obj)                                            \
     (NSIGNATURE_OF(mem_obj) == NSIGNATURE_STDHEAP)
+
+#if defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE >= 200112L)
+#define STDHEAP_USE_MEMALIGN            1
+#endif
     
 /*======================================================  LOCAL DATA TYPES  ==*/
 /*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
@@ -52,6 +57,17 @@ static void * stdheap_alloc_i(struct nmem * mem_class, size_t size);
 
 static void stdheap_free_i(struct nmem * mem_class, void * mem);
 
+#if defined(STDHEAP_USE_MEMALIGN)
+static void * stdheap_alloc_aligned_i(struct nmem * mem_class, size_t size,
+        size_t align);
+#endif
+
+static void * stdheap_realloc_i(struct nmem * mem_class, void * mem,
+        size_t old_size, size_t new_size);
+
+static void stdheap_free_sized_i(struct nmem * mem_class, void * mem,
+        size_t size);
+
 /*=======================================================  LOCAL VARIABLES  ==*/
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
@@ -75,6 +91,47 @@ static void stdheap_free_i(struct nmem * mem_class, void * mem)
     free(mem);
 }
 
+#if defined(STDHEAP_USE_MEMALIGN)
+static void * stdheap_alloc_aligned_i(struct nmem * mem_class, size_t size,
+        size_t align)
+{
+    void *                      mem;
+
+    NREQUIRE(N_IS_STDHEAP_OBJECT(mem_class));
+
+    (void)mem_class;
+
+    if (align < sizeof(void *)) {
+        align = sizeof(void *);
+    }
+
+    if (posix_memalign(&mem, align, size) != 0) {
+
+        return (NULL);
+    }
+
+    return (mem);
+}
+#endif
+
+static void * stdheap_realloc_i(struct nmem * mem_class, void * mem,
+        size_t old_size, size_t new_size)
+{
+    NREQUIRE(N_IS_STDHEAP_OBJECT(mem_class));
+
+    (void)mem_class;
+    (void)old_size;
+
+    return (realloc(mem, new_size));
+}
+
+static void stdheap_free_sized_i(struct nmem * mem_class, void * mem,
+        size_t size)
+{
+    (void)size;
+    stdheap_free_i(mem_class, mem);
+}
+
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
 
 
@@ -84,10 +141,24 @@ void nstdheap_init(struct nstdheap * stdheap_obj)
     NREQUIRE(NSIGNATURE_OF(&stdheap_obj->mem_class) != NSIGNATURE_STDHEAP);
 
     stdheap_obj->mem_class.base     = NULL;
+    stdheap_obj->mem_class.cursor   = NULL;
     stdheap_obj->mem_class.size     = 0u;
     stdheap_obj->mem_class.free     = 0u;
+    stdheap_obj->mem_class.no_blocks = 0u;
     stdheap_obj->mem_class.vf_alloc = stdheap_alloc_i;
     stdheap_obj->mem_class.vf_free  = stdheap_free_i;
+#if defined(STDHEAP_USE_MEMALIGN)
+    stdheap_obj->mem_class.vf_alloc_aligned = stdheap_alloc_aligned_i;
+#else
+    stdheap_obj->mem_class.vf_alloc_aligned = NULL;
+#endif
+    stdheap_obj->mem_class.vf_realloc       = stdheap_realloc_i;
+    stdheap_obj->mem_class.vf_free_sized    = stdheap_free_sized_i;
+#if (CONFIG_MEM_STATS == 1)
+    stdheap_obj->mem_class.vf_largest       = NULL;
+    memset(&stdheap_obj->mem_class.stats, 0,
+        sizeof(stdheap_obj->mem_class.stats));
+#endif
 
     NOBLIGATION(NSIGNATURE_IS(&stdheap_obj->mem_class, NSIGNATURE_STDHEAP));
 }
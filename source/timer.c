@@ -41,40 +41,116 @@
 #define NODE_TO_TIMER(node)                                                     \
     PORT_C_CONTAINER_OF(node, struct ntimer, list)
 
+#define WHEEL_SLOTS                     (0x1u << CONFIG_TIMER_WHEEL_BITS)
+
+#define WHEEL_MASK                      (WHEEL_SLOTS - 1u)
+
+/**@brief       Number of wheel levels needed to cover 32-bit tick range
+ */
+#define WHEEL_LEVELS                                                            \
+    ((32u + CONFIG_TIMER_WHEEL_BITS - 1u) / CONFIG_TIMER_WHEEL_BITS)
+
+#define WHEEL_INDEX(tick, level)                                                \
+    (((tick) >> ((level) * CONFIG_TIMER_WHEEL_BITS)) & WHEEL_MASK)
+
 /*======================================================  LOCAL DATA TYPES  ==*/
-/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
-/*=======================================================  LOCAL VARIABLES  ==*/
 
-static struct ntimer g_timer_sentinel =
+/**@brief       Hierarchical timing wheel
+ * @details     Level 0 has one slot per tick. Each slot of level N covers
+ *              as many ticks as the whole level N - 1. Timers are moved down
+ *              one level (cascaded) when the lower level wraps around.
+ */
+struct timer_wheel
 {
-	NSIGNATURE_INITIALIZER(NSIGNATURE_TIMER)
-    NDLIST_INITIALIZER(g_timer_sentinel.list),
-    UINT32_MAX,
-    0,
-    NULL,
-    NULL,
+    bool                        is_ready;
+    uint32_t                    n_timers;
+    uint32_t                    saved;  /**<@brief Wakeups saved by slack */
+#if (CONFIG_TIMER_BATCH == 1)
+    struct ndlist               expired;/**<@brief Callbacks to run       */
+#endif
+    struct ndlist               slot[WHEEL_LEVELS][WHEEL_SLOTS];
 };
 
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+/*=======================================================  LOCAL VARIABLES  ==*/
+
+static struct timer_wheel       g_timer_wheel;
+
+static volatile uint32_t        g_timer_tick;
+
 /*======================================================  GLOBAL VARIABLES  ==*/
 /*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
 
 
 static
-void insert_timer(struct ntimer * timer)
+void wheel_init(void)
 {
-    struct ntimer *         current;
+    uint32_t                    level;
+    uint32_t                    idx;
 
-    current = NODE_TO_TIMER(ndlist_next(&g_timer_sentinel.list));
+    for (level = 0u; level < WHEEL_LEVELS; level++) {
 
-    while (current->rtick < timer->rtick) {
-        timer->rtick -= current->rtick;
-        current       = NODE_TO_TIMER(ndlist_next(&current->list));
+        for (idx = 0u; idx < WHEEL_SLOTS; idx++) {
+            ndlist_init(&g_timer_wheel.slot[level][idx]);
+        }
     }
-    ndlist_add_before(&current->list, &timer->list);
+#if (CONFIG_TIMER_BATCH == 1)
+    ndlist_init(&g_timer_wheel.expired);
+#endif
+    g_timer_wheel.is_ready = true;
+}
+
 
-    if (&g_timer_sentinel != current) {
-        current->rtick -= timer->rtick;
+
+/**@brief       Move expire tick within slack to a coarse tick boundary
+ * @details     Returns the tick in range [expires, expires + slack] which has
+ *              the most trailing zero bits. Timers with overlapping slack
+ *              windows end up on the same tick and expire together.
+ */
+static
+uint32_t apply_slack(uint32_t expires, uint32_t slack)
+{
+    uint32_t                    limit;
+    uint32_t                    mask;
+
+    limit = expires + slack;
+    mask  = expires ^ limit;
+
+    if (mask == 0u) {
+
+        return (expires);
     }
+
+    while ((mask & (mask - 1u)) != 0u) {
+        mask &= mask - 1u;
+    }
+
+    return (limit & ~(mask - 1u));
+}
+
+
+
+static
+void insert_timer(struct ntimer * timer)
+{
+    uint32_t                    delta;
+    uint32_t                    level;
+
+    /* NOTE:
+     * Pick the lowest level which can hold the remaining ticks. The slot is
+     * selected by expire tick, so the timer is found again when the level is
+     * cascaded or when level 0 reaches it.
+     */
+    delta = timer->expires - g_timer_tick;
+    level = 0u;
+
+    while ((level < WHEEL_LEVELS - 1u) &&
+           (delta >= (0x1u << ((level + 1u) * CONFIG_TIMER_WHEEL_BITS)))) {
+        level++;
+    }
+    ndlist_add_before(
+        &g_timer_wheel.slot[level][WHEEL_INDEX(timer->expires, level)],
+        &timer->list);
 }
 
 
@@ -85,6 +161,48 @@ void remove_timer(struct ntimer * timer)
     ndlist_remove(&timer->list);
 }
 
+
+
+/**@brief       Insert a periodic timer again after it has expired
+ * @details     The next expire tick is always counted from the previous one,
+ *              so the period does not drift when callbacks are delayed. When
+ *              callbacks are batched the next tick may have already passed,
+ *              then the timer expires on the next tick. Without batching the
+ *              previous expire tick is the current tick, so both paths use
+ *              the same rule.
+ */
+static
+void rearm_timer(struct ntimer * timer)
+{
+    uint32_t                    expires;
+
+    expires = timer->expires + timer->itick;
+
+    if ((int32_t)(expires - g_timer_tick) <= 0) {
+        expires = g_timer_tick + 1u;
+    }
+    timer->expires = apply_slack(expires, timer->slack);
+    insert_timer(timer);
+}
+
+
+
+static
+void cascade_timers(uint32_t level)
+{
+    struct ndlist *             slot;
+
+    slot = &g_timer_wheel.slot[level][WHEEL_INDEX(g_timer_tick, level)];
+
+    while (!ndlist_is_empty(slot)) {
+        struct ntimer *         current;
+
+        current = NODE_TO_TIMER(ndlist_next(slot));
+        remove_timer(current);
+        insert_timer(current);
+    }
+}
+
 /*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
 
 
@@ -107,11 +225,8 @@ void ntimer_cancel_i(struct ntimer * timer)
     NREQUIRE(ncore_is_lock_valid());
 
     if (ntimer_is_running_i(timer)) {
-
-        if (&g_timer_sentinel != NODE_TO_TIMER(ndlist_next(&timer->list))) {
-            NODE_TO_TIMER(ndlist_next(&timer->list))->rtick += timer->rtick;
-        }
         remove_timer(timer);
+        g_timer_wheel.n_timers--;
     }
 }
 
@@ -128,8 +243,8 @@ void ntimer_cancel(struct ntimer * timer)
 
 
 
-void ntimer_start_i(struct ntimer * timer, uint32_t tick, void (* fn)(void *),
-		void * arg, uint8_t flags)
+void ntimer_start_i(struct ntimer * timer, uint32_t tick, uint32_t slack,
+        void (* fn)(void *), void * arg, uint8_t flags)
 {
     NREQUIRE(N_IS_TIMER_OBJECT(timer));
     NREQUIRE(tick > 0);
@@ -137,10 +252,14 @@ void ntimer_start_i(struct ntimer * timer, uint32_t tick, void (* fn)(void *),
     NREQUIRE(!ntimer_is_running_i(timer));
     NREQUIRE(ncore_is_lock_valid());
 
+    if (!g_timer_wheel.is_ready) {
+        wheel_init();
+    }
     tick++;
-    timer->fn    = fn;
-    timer->arg   = arg;
-    timer->rtick = tick;
+    timer->fn      = fn;
+    timer->arg     = arg;
+    timer->slack   = slack;
+    timer->expires = apply_slack(g_timer_tick + tick, slack);
 
     if (flags & NTIMER_ATTR_REPEAT) {
         timer->itick = tick;
@@ -148,17 +267,18 @@ void ntimer_start_i(struct ntimer * timer, uint32_t tick, void (* fn)(void *),
         timer->itick = 0u;
     }
     insert_timer(timer);
+    g_timer_wheel.n_timers++;
 }
 
 
 
-void ntimer_start(struct ntimer * timer, uint32_t tick, void (* fn)(void *),
-		void * arg, uint8_t flags)
+void ntimer_start(struct ntimer * timer, uint32_t tick, uint32_t slack,
+        void (* fn)(void *), void * arg, uint8_t flags)
 {
     ncore_lock                   sys_lock;
 
     ncore_lock_enter(&sys_lock);
-    ntimer_start_i(timer, tick, fn, arg, flags);
+    ntimer_start_i(timer, tick, slack, fn, arg, flags);
     ncore_lock_exit(&sys_lock);
 }
 
@@ -189,12 +309,13 @@ uint32_t ntimer_remaining(const struct ntimer * timer)
     remaining = 0u;
     ncore_lock_enter(&sys_lock);
 
-    if (ntimer_is_running_i(timer)) {
-
-        do {
-            remaining += timer->rtick;
-            timer      = NODE_TO_TIMER(ndlist_prev(&timer->list));
-        } while (timer != &g_timer_sentinel);
+    /* NOTE:
+     * An expired timer whose callback is waiting in the batch has no time
+     * remaining.
+     */
+    if (ntimer_is_running_i(timer) &&
+        ((int32_t)(timer->expires - g_timer_tick) > 0)) {
+        remaining = timer->expires - g_timer_tick;
     }
     ncore_lock_exit(&sys_lock);
 
@@ -203,34 +324,121 @@ uint32_t ntimer_remaining(const struct ntimer * timer)
 
 
 
+uint32_t ntimer_get_tick(void)
+{
+    return (g_timer_tick);
+}
+
+
+
+uint32_t ntimer_saved_wakeups(void)
+{
+    return (g_timer_wheel.saved);
+}
+
+
+
 void ncore_timer_isr(void)
 {
     NREQUIRE(ncore_is_lock_valid());
 
-    if (!ndlist_is_empty(&g_timer_sentinel.list)) {
-        struct ntimer *         current;
+    g_timer_tick++;
 
-        current = NODE_TO_TIMER(ndlist_next(&g_timer_sentinel.list));
-        NASSERT_INTERNAL(N_IS_TIMER_OBJECT(current));
-        --current->rtick;
+    if (g_timer_wheel.n_timers != 0u) {
+        struct ndlist *         slot;
+        uint32_t                level;
+        uint32_t                expired;
+
+        /* NOTE:
+         * When level 0 wraps around cascade the higher levels, starting from
+         * the highest one which has wrapped, so timers fall through to level 0
+         * in a single tick.
+         */
+        level = 0u;
+
+        while ((level < WHEEL_LEVELS - 1u) &&
+               (WHEEL_INDEX(g_timer_tick, level) == 0u)) {
+            level++;
+        }
+
+        while (level != 0u) {
+            cascade_timers(level);
+            level--;
+        }
+        slot    = &g_timer_wheel.slot[0][WHEEL_INDEX(g_timer_tick, 0u)];
+        expired = 0u;
 
-        while (current->rtick == 0u) {
-            struct ntimer *     tmp;
+        while (!ndlist_is_empty(slot)) {
+            struct ntimer *     current;
 
+            current = NODE_TO_TIMER(ndlist_next(slot));
+            NASSERT_INTERNAL(N_IS_TIMER_OBJECT(current));
             remove_timer(current);
 
+            if ((current->slack != 0u) && (expired != 0u)) {
+                g_timer_wheel.saved++;
+            }
+            expired++;
+
+#if (CONFIG_TIMER_BATCH == 1)
+            ndlist_add_before(&g_timer_wheel.expired, &current->list);
+#else
             if (current->itick != 0u) {
-                current->rtick = current->itick;
-                insert_timer(current);
+                rearm_timer(current);
+            } else {
+                g_timer_wheel.n_timers--;
             }
-            tmp     = current;
-            current = NODE_TO_TIMER(ndlist_next(&g_timer_sentinel.list));
-            NASSERT_INTERNAL(N_IS_TIMER_OBJECT(current));
-            tmp->fn(tmp->arg);
+            current->fn(current->arg);
+#endif
         }
     }
 }
 
+
+
+#if (CONFIG_TIMER_BATCH == 1)
+void ntimer_run_expired(void)
+{
+    ncore_lock                  sys_lock;
+
+    ncore_lock_enter(&sys_lock);
+
+    /* NOTE:
+     * The port may run the batch on every tick, even before any timer was
+     * started and the wheel was set up.
+     */
+    if (!g_timer_wheel.is_ready) {
+        ncore_lock_exit(&sys_lock);
+
+        return;
+    }
+
+    /* NOTE:
+     * Timers stay in the batch until their callback runs, so a timer
+     * cancelled in the meantime is simply removed from the batch. The lock
+     * is released after each callback so a burst of expiries does not block
+     * other threads for the whole batch.
+     */
+    while (!ndlist_is_empty(&g_timer_wheel.expired)) {
+        struct ntimer *         current;
+
+        current = NODE_TO_TIMER(ndlist_next(&g_timer_wheel.expired));
+        NASSERT_INTERNAL(N_IS_TIMER_OBJECT(current));
+        remove_timer(current);
+
+        if (current->itick != 0u) {
+            rearm_timer(current);
+        } else {
+            g_timer_wheel.n_timers--;
+        }
+        current->fn(current->arg);
+        ncore_lock_exit(&sys_lock);
+        ncore_lock_enter(&sys_lock);
+    }
+    ncore_lock_exit(&sys_lock);
+}
+#endif
+
 /*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
 /** @endcond *//** @} *//** @} *//*********************************************
  * END of timer.c
@@ -0,0 +1,483 @@
+/*
+ * This file is part of Neon.
+ *
+ * Copyright (C) 2010 - 2015 Nenad Radulovic
+ *
+ * Neon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Neon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Neon.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * web site:    http://github.com/nradulovic
+ * e-mail  :    nenad.b.radulovic@gmail.com
+ *//***********************************************************************//**
+ * @file
+ * @author      Nenad Radulovic
+ * @brief       Two-level segregated fit memory management implementation
+ * @addtogroup  mm_tlsf
+ *********************************************************************//** @{ */
+/**@defgroup    mm_tlsf_impl Implementation
+ * @brief       Two-level segregated fit memory management implementation
+ * @{ *//*--------------------------------------------------------------------*/
+
+/*=========================================================  INCLUDE FILES  ==*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "port/core.h"
+#include "base/debug.h"
+#include "base/bitop.h"
+#include "mm/tlsf.h"
+
+/*=========================================================  LOCAL MACRO's  ==*/
+
+/**@brief       Number of second level bins is 2^TLSF_SL_BITS
+ */
+#define TLSF_SL_BITS                    4u
+
+#define TLSF_SL_COUNT                   (1u << TLSF_SL_BITS)
+
+/**@brief       Size of block header, block sizes are multiples of this value
+ */
+#define TLSF_HDR_SIZE                   offsetof(struct tlsf_block, next_free)
+
+#define TLSF_ALIGN_SHIFT                NLOG2_8(TLSF_HDR_SIZE)
+
+/**@brief       Blocks smaller than this size are all in the first level 0
+ */
+#define TLSF_FL_SHIFT                   (TLSF_SL_BITS + TLSF_ALIGN_SHIFT)
+
+#define TLSF_FL_COUNT                                                           \
+    (CONFIG_TLSF_MAX_SIZE_BITS - TLSF_FL_SHIFT + 1u)
+
+#define TLSF_SMALL_BLOCK                ((size_t)1u << TLSF_FL_SHIFT)
+
+#define TLSF_MAX_SIZE                   ((size_t)1u << CONFIG_TLSF_MAX_SIZE_BITS)
+
+/**@brief       Block is free, stored in the lowest bit of block size
+ */
+#define BLOCK_FREE                      ((size_t)1u)
+
+#define BLOCK_SIZE(block)               ((block)->size & ~BLOCK_FREE)
+
+#define BLOCK_IS_FREE(block)            (((block)->size & BLOCK_FREE) != 0u)
+
+#define BLOCK_PAYLOAD(block)            ((uint8_t *)(block) + TLSF_HDR_SIZE)
+
+#define BLOCK_NEXT(block)                                                       \
+    ((struct tlsf_block *)(BLOCK_PAYLOAD(block) + BLOCK_SIZE(block)))
+
+/*======================================================  LOCAL DATA TYPES  ==*/
+
+/**@brief       First level bitmap type
+ * @details     Storage larger than 2GB needs more than 32 first level indexes.
+ */
+#if (CONFIG_TLSF_MAX_SIZE_BITS > 31u)
+typedef uint64_t tlsf_fl_bitmap;
+#else
+typedef uint32_t tlsf_fl_bitmap;
+#endif
+
+/**@brief       TLSF memory block header structure
+ * @details     Free list pointers are valid only while the block is free, they
+ *              occupy the first bytes of block payload.
+ */
+struct tlsf_block
+{
+    struct tlsf_block *         prev_phys;
+    size_t                      size;
+    struct tlsf_block *         next_free;
+    struct tlsf_block *         prev_free;
+};
+
+/**@brief       TLSF control structure
+ */
+struct tlsf_control
+{
+    tlsf_fl_bitmap              fl_bitmap;
+    uint32_t                    sl_bitmap[TLSF_FL_COUNT];
+    struct tlsf_block *         bin[TLSF_FL_COUNT][TLSF_SL_COUNT];
+};
+
+/*=============================================  LOCAL FUNCTION PROTOTYPES  ==*/
+
+static uint_fast8_t tlsf_fls(size_t value);
+
+static uint_fast8_t tlsf_ffs(tlsf_fl_bitmap value);
+
+static void mapping_insert(size_t size, uint_fast8_t * fl, uint_fast8_t * sl);
+
+static void mapping_search(size_t size, uint_fast8_t * fl, uint_fast8_t * sl);
+
+static struct tlsf_block * find_suitable(struct tlsf_control * control,
+        uint_fast8_t * fl, uint_fast8_t * sl);
+
+static void block_insert(struct tlsf_control * control,
+        struct tlsf_block * block);
+
+static void block_remove(struct tlsf_control * control,
+        struct tlsf_block * block);
+
+static void * tlsf_alloc(struct nmem * tlsf_obj, size_t size);
+
+static void tlsf_free(struct nmem * tlsf_obj, void * mem);
+
+#if (CONFIG_MEM_STATS == 1)
+static size_t tlsf_largest(struct nmem * tlsf_obj);
+#endif
+
+/*=======================================================  LOCAL VARIABLES  ==*/
+/*======================================================  GLOBAL VARIABLES  ==*/
+/*============================================  LOCAL FUNCTION DEFINITIONS  ==*/
+
+
+/**@brief       Index of the most significant set bit
+ */
+static uint_fast8_t tlsf_fls(size_t value)
+{
+#if defined(__GNUC__)
+    return ((uint_fast8_t)(sizeof(unsigned long) * 8u - 1u -
+        (unsigned)__builtin_clzl((unsigned long)value)));
+#else
+    uint_fast8_t                bit = 0u;
+
+    while ((value >>= 1u) != 0u) {
+        bit++;
+    }
+
+    return (bit);
+#endif
+}
+
+
+
+/**@brief       Index of the least significant set bit
+ */
+static uint_fast8_t tlsf_ffs(tlsf_fl_bitmap value)
+{
+#if defined(__GNUC__) && (CONFIG_TLSF_MAX_SIZE_BITS > 31u)
+    return ((uint_fast8_t)__builtin_ctzll(value));
+#elif defined(__GNUC__)
+    return ((uint_fast8_t)__builtin_ctz(value));
+#else
+    uint_fast8_t                bit = 0u;
+
+    while ((value & 0x1u) == 0u) {
+        value >>= 1u;
+        bit++;
+    }
+
+    return (bit);
+#endif
+}
+
+
+
+/**@brief       Find bin indexes of a block of given size
+ */
+static void mapping_insert(size_t size, uint_fast8_t * fl, uint_fast8_t * sl)
+{
+    if (size < TLSF_SMALL_BLOCK) {
+        *fl = 0u;
+        *sl = (uint_fast8_t)(size >> TLSF_ALIGN_SHIFT);
+    } else {
+        uint_fast8_t            msb = tlsf_fls(size);
+
+        *fl = (uint_fast8_t)(msb - TLSF_FL_SHIFT + 1u);
+        *sl = (uint_fast8_t)((size >> (msb - TLSF_SL_BITS)) - TLSF_SL_COUNT);
+    }
+}
+
+
+
+/**@brief       Find bin indexes where all blocks are at least of given size
+ */
+static void mapping_search(size_t size, uint_fast8_t * fl, uint_fast8_t * sl)
+{
+    if (size >= TLSF_SMALL_BLOCK) {
+        size += ((size_t)1u << (tlsf_fls(size) - TLSF_SL_BITS)) - 1u;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+
+
+static struct tlsf_block * find_suitable(struct tlsf_control * control,
+        uint_fast8_t * fl, uint_fast8_t * sl)
+{
+    uint32_t                    sl_map;
+
+    sl_map = control->sl_bitmap[*fl] & (~(uint32_t)0u << *sl);
+
+    if (sl_map == 0u) {
+        tlsf_fl_bitmap          fl_map;
+
+        fl_map = control->fl_bitmap & (~(tlsf_fl_bitmap)0u << (*fl + 1u));
+
+        if (fl_map == 0u) {
+
+            return (NULL);
+        }
+        *fl    = tlsf_ffs(fl_map);
+        sl_map = control->sl_bitmap[*fl];
+    }
+    *sl = tlsf_ffs(sl_map);
+
+    return (control->bin[*fl][*sl]);
+}
+
+
+
+static void block_insert(struct tlsf_control * control,
+        struct tlsf_block * block)
+{
+    uint_fast8_t                fl;
+    uint_fast8_t                sl;
+
+    mapping_insert(BLOCK_SIZE(block), &fl, &sl);
+    block->size     |= BLOCK_FREE;
+    block->prev_free = NULL;
+    block->next_free = control->bin[fl][sl];
+
+    if (block->next_free) {
+        block->next_free->prev_free = block;
+    }
+    control->bin[fl][sl]  = block;
+    control->fl_bitmap   |= (tlsf_fl_bitmap)1u << fl;
+    control->sl_bitmap[fl] |= (uint32_t)1u << sl;
+}
+
+
+
+static void block_remove(struct tlsf_control * control,
+        struct tlsf_block * block)
+{
+    uint_fast8_t                fl;
+    uint_fast8_t                sl;
+
+    mapping_insert(BLOCK_SIZE(block), &fl, &sl);
+    block->size &= ~BLOCK_FREE;
+
+    if (block->next_free) {
+        block->next_free->prev_free = block->prev_free;
+    }
+
+    if (block->prev_free) {
+        block->prev_free->next_free = block->next_free;
+    } else {
+        control->bin[fl][sl] = block->next_free;
+
+        if (block->next_free == NULL) {
+            control->sl_bitmap[fl] &= ~((uint32_t)1u << sl);
+
+            if (control->sl_bitmap[fl] == 0u) {
+                control->fl_bitmap &= ~((tlsf_fl_bitmap)1u << fl);
+            }
+        }
+    }
+}
+
+
+
+static void * tlsf_alloc(struct nmem * tlsf_obj, size_t size)
+{
+    struct tlsf_control *       control;
+    struct tlsf_block *         block;
+    uint_fast8_t                fl;
+    uint_fast8_t                sl;
+    size_t                      rest;
+
+    NREQUIRE(NSIGNATURE_OF(tlsf_obj) == NSIGNATURE_TLSF);
+    NREQUIRE(size != 0u);
+    NREQUIRE(ncore_is_lock_valid());
+
+    if (size >= TLSF_MAX_SIZE) {
+
+        return (NULL);
+    }
+    control = tlsf_obj->base;
+    size    = NALIGN_UP(size, TLSF_HDR_SIZE);
+    mapping_search(size, &fl, &sl);
+
+    if (fl >= TLSF_FL_COUNT) {
+
+        return (NULL);
+    }
+    block = find_suitable(control, &fl, &sl);
+
+    if (block == NULL) {
+
+        return (NULL);
+    }
+    block_remove(control, block);
+    rest = BLOCK_SIZE(block) - size;
+
+                                        /* Return the tail of the block if it */
+                                        /* can hold another block.            */
+    if (rest >= TLSF_HDR_SIZE * 2u) {
+        struct tlsf_block *     tail;
+
+        block->size     = size;
+        tail            = BLOCK_NEXT(block);
+        tail->prev_phys = block;
+        tail->size      = rest - TLSF_HDR_SIZE;
+        BLOCK_NEXT(tail)->prev_phys = tail;
+        block_insert(control, tail);
+        tlsf_obj->free -= size + TLSF_HDR_SIZE;
+    } else {
+        tlsf_obj->free -= BLOCK_SIZE(block);
+    }
+
+    return ((void *)BLOCK_PAYLOAD(block));
+}
+
+
+
+static void tlsf_free(struct nmem * tlsf_obj, void * mem)
+{
+    struct tlsf_control *       control;
+    struct tlsf_block *         block;
+    struct tlsf_block *         next;
+
+    NREQUIRE(NSIGNATURE_OF(tlsf_obj) == NSIGNATURE_TLSF);
+    NREQUIRE(mem);
+    NREQUIRE(ncore_is_lock_valid());
+
+    control = tlsf_obj->base;
+    block   = (struct tlsf_block *)((uint8_t *)mem - TLSF_HDR_SIZE);
+
+    NREQUIRE(!BLOCK_IS_FREE(block));
+
+    tlsf_obj->free += block->size;
+    next            = BLOCK_NEXT(block);
+
+                                        /* Merge with the next block          */
+    if (BLOCK_IS_FREE(next)) {
+        block_remove(control, next);
+        block->size    += TLSF_HDR_SIZE + next->size;
+        tlsf_obj->free += TLSF_HDR_SIZE;
+        next            = BLOCK_NEXT(block);
+        next->prev_phys = block;
+    }
+                                        /* Merge with the previous block      */
+    if (block->prev_phys && BLOCK_IS_FREE(block->prev_phys)) {
+        struct tlsf_block *     prev = block->prev_phys;
+
+        block_remove(control, prev);
+        prev->size     += TLSF_HDR_SIZE + block->size;
+        tlsf_obj->free += TLSF_HDR_SIZE;
+        next->prev_phys = prev;
+        block           = prev;
+    }
+    block_insert(control, block);
+}
+
+
+
+#if (CONFIG_MEM_STATS == 1)
+/**@brief       Size of the largest free block
+ * @details     The largest block is in the highest non-empty bin, but blocks
+ *              in a bin are not sorted, so the bin is searched.
+ */
+static size_t tlsf_largest(struct nmem * tlsf_obj)
+{
+    struct tlsf_control *       control = tlsf_obj->base;
+    struct tlsf_block *         block;
+    uint_fast8_t                fl;
+    uint_fast8_t                sl;
+    size_t                      largest;
+
+    if (control->fl_bitmap == 0u) {
+
+        return (0u);
+    }
+    fl      = tlsf_fls(control->fl_bitmap);
+    sl      = tlsf_fls(control->sl_bitmap[fl]);
+    largest = 0u;
+
+    for (block = control->bin[fl][sl]; block; block = block->next_free) {
+
+        if (BLOCK_SIZE(block) > largest) {
+            largest = BLOCK_SIZE(block);
+        }
+    }
+
+    return (largest);
+}
+#endif
+
+/*===========================================  GLOBAL FUNCTION DEFINITIONS  ==*/
+
+
+void * tlsf_init_alloc(struct nmem * tlsf_obj, size_t size)
+{
+    struct tlsf_control *       control;
+    struct tlsf_block *         begin;
+    struct tlsf_block *         sentinel;
+    uintptr_t                   start;
+    uintptr_t                   end;
+    uint_fast8_t                fl;
+
+    NREQUIRE(NSIGNATURE_OF(tlsf_obj) == NSIGNATURE_TLSF);
+    NREQUIRE(tlsf_obj->base);
+
+    start   = NALIGN_UP((uintptr_t)tlsf_obj->base, TLSF_HDR_SIZE);
+    end     = NALIGN((uintptr_t)tlsf_obj->base + tlsf_obj->size,
+        TLSF_HDR_SIZE);
+    control = (struct tlsf_control *)start;
+    begin   = (struct tlsf_block *)
+        NALIGN_UP(start + sizeof(*control), TLSF_HDR_SIZE);
+                                             /* Sentinel is the last element */
+    sentinel = (struct tlsf_block *)(end - TLSF_HDR_SIZE);
+
+    NREQUIRE((uintptr_t)sentinel >= (uintptr_t)begin + TLSF_HDR_SIZE * 2u);
+    NREQUIRE((size_t)((uintptr_t)sentinel - (uintptr_t)begin) < TLSF_MAX_SIZE);
+
+    control->fl_bitmap = 0u;
+
+    for (fl = 0u; fl < TLSF_FL_COUNT; fl++) {
+        uint_fast8_t            sl;
+
+        control->sl_bitmap[fl] = 0u;
+
+        for (sl = 0u; sl < TLSF_SL_COUNT; sl++) {
+            control->bin[fl][sl] = NULL;
+        }
+    }
+    begin->prev_phys   = NULL;
+    begin->size        = (size_t)((uintptr_t)sentinel - (uintptr_t)begin) -
+        TLSF_HDR_SIZE;
+    sentinel->prev_phys = begin;
+    sentinel->size      = 0u;            /* Used block which is never merged */
+    block_insert(control, begin);
+
+    tlsf_obj->base     = control;
+    tlsf_obj->size     = BLOCK_SIZE(begin);
+    tlsf_obj->free     = BLOCK_SIZE(begin);
+    tlsf_obj->vf_alloc = tlsf_alloc;
+    tlsf_obj->vf_free  = tlsf_free;
+#if (CONFIG_MEM_STATS == 1)
+    tlsf_obj->vf_largest = tlsf_largest;
+#endif
+
+    return (tlsf_alloc(tlsf_obj, size));
+}
+
+/*================================*//** @cond *//*==  CONFIGURATION ERRORS  ==*/
+
+#if (CONFIG_TLSF_MAX_SIZE_BITS > 31u) && (SIZE_MAX <= UINT32_MAX)
+# error "NEON::eds::mm: Configuration option CONFIG_TLSF_MAX_SIZE_BITS is out of range: 12 - 31 on targets with 32 bit size_t"
+#endif
+
+/** @endcond *//** @} *//** @} *//*********************************************
+ * END of tlsf.c
+ ******************************************************************************/